@@ -1,10 +1,42 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <istream>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace aoc::day3 {
+  /* totals = running answers of a schematic
+   * where:
+   *  part_numbers is the sum of all numbers adjacent to a symbol
+   *  gear_ratios is the sum of the products of the '*'s with 2 numbers
+   */
+  struct totals {
+    std::uint64_t part_numbers = 0;
+    std::uint64_t gear_ratios = 0;
+  };
+
+  /* labels the whole schematic at once and resolves every symbol against the
+   * labels around it, this is the serial reference the streaming and banded
+   * scans must agree with
+   */
+  auto label_totals(std::vector<std::string> const& rows) -> totals;
+
+  /* streams the schematic keeping only the previous, current and next rows,
+   * a row is resolved as soon as its lower neighbor arrives and on_row is
+   * called with its index and the partial totals up to it
+   */
+  auto scan(std::istream& input,
+            std::function<void(size_t, totals const&)> const& on_row = {})
+    -> totals;
+
+  /* splits the rows in horizontal bands and scans them on the shared thread
+   * pool, small schematics run as a single band on the calling thread
+   */
+  auto scan_bands(std::vector<std::string> const& rows) -> totals;
+
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>, std::function<std::string()>>;
 } // namespace aoc::dayn
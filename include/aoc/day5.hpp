@@ -1,10 +1,146 @@
 #pragma once
 
+#include <concepts>
+#include <cstdint>
 #include <functional>
 #include <istream>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace aoc::day5 {
+  /* all the day 5 types are templated on the width of the almanac values,
+   * the 64 bit instantiation handles the big almanacs and the 32 bit one
+   * keeps twice the lanes in the batched lookups
+   */
+  template <std::unsigned_integral T>
+  using basic_range = std::pair<T, T>;
+
+  template <std::unsigned_integral T>
+  using basic_entry = std::pair<T, basic_range<T>>;
+
+  // an integer wide enough to hold max(T) + 1 (and max(T) + max(T))
+  template <std::unsigned_integral T>
+  using wide_t = std::conditional_t<(sizeof(T) < sizeof(std::uint64_t)),
+                                    std::uint64_t, unsigned __int128>;
+
+  /* interval = <start, end>
+   * where:
+   *  all the values from start (inclusive) to end (exclusive) are in the
+   *  interval, the bounds are wider than T so start + size never overflows
+   */
+  template <std::unsigned_integral T>
+  using basic_interval = std::pair<wide_t<T>, wide_t<T>>;
+
+  /* interval_map = entries sorted by source start, stored as flat arrays
+   * where:
+   *  src_starts, dst_starts and sizes are the entries in struct of arrays
+   *  form, slot 0 is an empty entry so that any rank is a valid slot
+   *  tree holds the src_starts in eytzinger (bfs) order, padded with max
+   *  values up to a perfect tree of the given depth, so every search takes
+   *  exactly depth branchless steps and the path taken is the rank of the key
+   */
+  template <std::unsigned_integral T>
+  class basic_interval_map {
+    using entry = basic_entry<T>;
+    using interval = basic_interval<T>;
+    using wide = wide_t<T>;
+
+    static constexpr wide domain_end =
+      wide { std::numeric_limits<T>::max() } + 1;
+
+    std::vector<T> src_starts { 0 };
+    std::vector<T> dst_starts { 0 };
+    std::vector<T> sizes { 0 };
+    std::vector<T> tree { 0 };
+    size_t depth = 0;
+
+    basic_interval_map(std::vector<entry> const& sorted_entries);
+
+    // number of entries whose source start is <= key
+    [[nodiscard]] auto rank(T key) const -> size_t;
+    [[nodiscard]] auto resolve(size_t slot, T key) const -> T {
+      T offset = key - src_starts[slot];
+      return offset < sizes[slot] ? dst_starts[slot] + offset : key;
+    }
+
+  public:
+    // keys resolved together by search_many, a cache line worth of keys
+    static constexpr size_t lanes = 64 / sizeof(T);
+
+    static auto from_entries(std::vector<entry>&& entries)
+      -> basic_interval_map;
+    [[nodiscard]] auto search(T key) const -> T;
+    auto search_many(std::span<const T> keys, std::span<T> results) const
+      -> void;
+    [[nodiscard]] auto map_intervals(
+      std::vector<interval> const& intervals) const -> std::vector<interval>;
+    [[nodiscard]] auto compose(basic_interval_map const& next) const
+      -> basic_interval_map;
+
+    /* lowest image of any key inside the sorted disjoint targets, the
+     * pieces (entries and the identity gaps between them) are visited in
+     * order of their lowest image, so the walk stops at the first piece
+     * that cannot beat the best image found so far
+     */
+    [[nodiscard]] auto lowest_image_of(std::vector<interval> const& targets)
+      const -> std::optional<T>;
+  };
+
+  template <std::unsigned_integral T>
+  class basic_almanac {
+    using interval = basic_interval<T>;
+    using interval_map = basic_interval_map<T>;
+
+    basic_almanac(std::vector<T> seeds, std::vector<interval_map> maps);
+
+  public:
+    std::vector<T> seeds;
+    std::vector<interval_map> maps;
+    // all the maps composed into a single seed => location map
+    interval_map fused;
+
+    /* throws std::overflow_error when a map entry runs past the end of the
+     * domain of T
+     */
+    auto static from_str(const std::string&& str) -> basic_almanac;
+
+    // the seeds line read as <start, count> pairs
+    [[nodiscard]] auto seed_intervals() const -> std::vector<interval>;
+
+    [[nodiscard]] auto map_seeds(const std::vector<T>& seeds) const -> T;
+
+    /* maps whole intervals through the fused map, splitting them at its
+     * breakpoints, the answer is the lowest start of the final intervals
+     * (max(T) when there are none, like map_seeds without seeds)
+     */
+    [[nodiscard]] auto map_intervals(
+      std::vector<interval> const& intervals) const -> T;
+
+    /* inverse mode: walks the pieces of fused from the lowest location
+     * upward and stops once no piece can hold a lower location with a seed
+     * inside the intervals, O(breakpoints * log intervals) regardless of
+     * their sizes
+     */
+    [[nodiscard]] auto lowest_location_inverse(
+      std::vector<interval> intervals) const -> std::optional<T>;
+  };
+
+  extern template class basic_interval_map<std::uint32_t>;
+  extern template class basic_interval_map<std::uint64_t>;
+  extern template class basic_almanac<std::uint32_t>;
+  extern template class basic_almanac<std::uint64_t>;
+
+  using range = basic_range<std::uint64_t>;
+  using entry = basic_entry<std::uint64_t>;
+  using interval = basic_interval<std::uint64_t>;
+  using interval_map = basic_interval_map<std::uint64_t>;
+  using almanac = basic_almanac<std::uint64_t>;
+
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>, std::function<std::string()>>;
 } // namespace aoc::day5
@@ -1,10 +1,28 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <istream>
+#include <span>
+#include <string>
 #include <utility>
 
 namespace aoc::day6 {
+  /* race values are read as 128 bit integers, races whose time^2 fits in
+   * 128 bits are solved in closed form and the others by bisection
+   */
+  using value = unsigned __int128;
+
+  // number of hold times that beat the distance, exact at 128 bits
+  auto count_wins(value time, value distance) -> value;
+
+  /* solves many races at once, races below 2^26 take a double sqrt and a
+   * one step fix up, only races too big for exact doubles take count_wins
+   */
+  auto count_wins_batch(std::span<const std::uint64_t> times,
+                        std::span<const std::uint64_t> distances,
+                        std::span<std::uint64_t> wins) -> void;
+
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>, std::function<std::string()>>;
 } // namespace aoc::day5
@@ -1,10 +1,71 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <istream>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 
 namespace aoc::day7 {
+  /* the rule sets of the two parts, they rank the cards and classify the
+   * hands and are defined along with the ranking of the hands
+   */
+  struct standard_rules;
+  struct joker_rules;
+
+  /* leaderboard = total winnings of a set of hands, kept up to date as hands
+   * are inserted and erased
+   * where:
+   *  every possible hand has a slot, the slots being in ranking order, and
+   *  a fenwick tree over the slots counts the hands and sums their bids, so
+   *  the rank of a hand and the bids of the hands above it take O(log n)
+   *  tree only holds the nodes on the update paths of the hands currently
+   *  in the leaderboard, so its size follows the hands, not the slots
+   *  bids maps the slots of the hands in the leaderboard to their bid
+   */
+  template <typename Rules>
+  class basic_leaderboard {
+  public:
+    /* inserts the hand, or replaces its bid when it is already there,
+     * throws std::invalid_argument when hand is not 5 valid cards
+     */
+    auto insert(std::string_view hand, std::uint32_t bid) -> void;
+
+    // erases the hand, returns false when it was not there
+    auto erase(std::string_view hand) -> bool;
+
+    [[nodiscard]] auto size() const -> size_t { return bids.size(); }
+
+    [[nodiscard]] auto total_winnings() const -> std::uint64_t {
+      return total;
+    }
+
+  private:
+    struct node {
+      std::uint32_t count = 0;
+      std::uint64_t bid_sum = 0;
+    };
+
+    std::unordered_map<std::uint32_t, node> tree;
+    std::unordered_map<std::uint32_t, std::uint32_t> bids;
+    std::uint64_t bid_total = 0;
+    std::uint64_t total = 0;
+
+    [[nodiscard]] auto slot_of(std::string_view hand) const -> std::uint32_t;
+    auto update(std::uint32_t slot, std::uint32_t bid, bool add) -> void;
+
+    // what the hand in slot with this bid adds to the total winnings
+    [[nodiscard]] auto winnings(std::uint32_t slot, std::uint32_t bid) const
+      -> std::uint64_t;
+  };
+
+  extern template class basic_leaderboard<standard_rules>;
+  extern template class basic_leaderboard<joker_rules>;
+
+  using leaderboard = basic_leaderboard<standard_rules>;
+  using joker_leaderboard = basic_leaderboard<joker_rules>;
+
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>,
                  std::function<std::string()>> const;
@@ -1,13 +1,19 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <format>
 #include <functional>
 #include <istream>
-#include <map>
+#include <memory>
+#include <optional>
 #include <ranges>
 #include <regex>
+#include <span>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 namespace aoc::day8 {
   enum class instruction : char {
@@ -18,16 +24,186 @@ namespace aoc::day8 {
   auto operator>>(std::istream& is, aoc::day8::instruction& i) -> std::istream&;
   auto operator<<(std::ostream& os, aoc::day8::instruction i) -> std::ostream&;
 
+  /* node names are 3 characters out of [0-9A-Z], packed in base 36 into
+   * 16 bits (letters only would fit in 15, but the examples use digits too)
+   * encode_name throws std::invalid_argument on any other name
+   */
+  static constexpr std::uint32_t name_codes = 36 * 36 * 36;
+
+  auto encode_name(std::string_view name) -> std::uint16_t;
+  auto decode_name(std::uint16_t code) -> std::string;
+
+  // node_set = a bitset over the node ids of a graph
+  struct node_set {
+    std::vector<std::uint64_t> words;
+
+    explicit node_set(std::uint32_t nodes) : words((nodes + 63) / 64) {}
+
+    auto insert(std::uint32_t node) -> void {
+      words[node / 64] |= std::uint64_t { 1 } << (node % 64);
+    }
+
+    [[nodiscard]] auto contains(std::uint32_t node) const -> bool {
+      return ((words[node / 64] >> (node % 64)) & 1) != 0;
+    }
+  };
+
+  /* graph = the network with its node names interned to dense ids
+   * where:
+   *  names[id] is the packed name of the node, ids follow the order in
+   *  which the names first appear in the entries
+   *  links holds the left successor of every node followed by the right
+   *  successor of every node, so a step is a single load of
+   *  links[side * size() + id]
+   *  storage owns the arrays, copies of the graph share it
+   */
   struct graph {
-    std::map<std::string, std::pair<std::string, std::string>> nodes;
+    std::span<std::uint16_t const> names;
+    std::span<std::uint32_t const> links;
+    std::shared_ptr<void const> storage;
     using entry = std::pair<std::string, std::pair<std::string, std::string>>;
 
     static auto from_entries(std::ranges::range auto&& entries) -> graph;
+
+    [[nodiscard]] auto size() const -> std::uint32_t {
+      return static_cast<std::uint32_t>(names.size());
+    }
+
+    [[nodiscard]] auto next(std::uint32_t node, instruction i) const
+      -> std::uint32_t {
+      return links[(i == instruction::right ? size() : 0) + node];
+    }
+
+    // the nodes whose name matches pattern, each name is matched once
+    [[nodiscard]] auto matching(std::regex const& pattern) const -> node_set;
+
+    // walks advanced together by simulate, one per 32 bit lane of an avx2
+    static constexpr std::size_t lanes = 8;
+
+    // steps simulated by traverse before it falls back to the cycles
+    static constexpr std::uint64_t simulated_steps = 1 << 12;
+
+    /* first step at which every walk from starts stands on an end node,
+     * found by walking them all in lock step (with avx2 gathers when the
+     * cpu has them), std::nullopt when that does not happen within
+     * max_steps steps
+     */
+    [[nodiscard]] auto simulate(std::span<instruction const> instructions,
+                                std::span<std::uint32_t const> starts,
+                                node_set const& ends,
+                                std::uint64_t max_steps) const
+      -> std::optional<std::uint64_t>;
+
     [[nodiscard]] auto traverse(std::ranges::range auto&& instructions,
                                 std::regex begin, std::regex end) const
       -> std::uint64_t;
   };
 
+  /* walk_cycle = the steps at which a walk stands on an end node
+   * where:
+   *  the walk is back to the same node at the start of a pass after tail
+   *  steps and again every period steps from then on
+   *  tail_hits are the hits before the cycle, in order
+   *  cycle_hits are the hits of one lap of the cycle, in order, as offsets
+   *  in [0, period) from the start of the lap
+   */
+  struct walk_cycle {
+    std::uint64_t tail = 0;
+    std::uint64_t period = 0;
+    std::vector<std::uint64_t> tail_hits;
+    std::vector<std::uint64_t> cycle_hits;
+
+    [[nodiscard]] auto is_hit(std::uint64_t step) const -> bool;
+  };
+
+  /* pass_table = where the nodes lead after whole passes of the
+   * instructions, with binary lifting over the number of passes
+   * where:
+   *  period is the length of one pass
+   *  hit_offsets[hit_starts[id]] to hit_offsets[hit_starts[id + 1]] are the
+   *  offsets in [0, period), in order, of the end nodes visited by the pass
+   *  starting at id, offset 0 being id itself
+   *  jumps[k * nodes + id] is the node reached from id after 2^k passes
+   *  hits[k * nodes + id] tells whether those 2^k passes visit an end node
+   *  there are enough levels for any step count that fits in 64 bits
+   */
+  struct pass_table {
+    std::uint64_t period = 0;
+    std::uint32_t nodes = 0;
+    std::uint32_t levels = 0;
+    std::vector<std::uint32_t> hit_starts;
+    std::vector<std::uint32_t> hit_offsets;
+    std::vector<std::uint32_t> jumps;
+    std::vector<bool> hits;
+
+    /* throws std::invalid_argument when there are no instructions, or too
+     * many for the offsets to fit in 32 bits
+     */
+    static auto from_graph(graph const& g,
+                           std::span<instruction const> instructions,
+                           node_set const& ends) -> pass_table;
+
+    /* the node reached from node after the given number of passes, there
+     * are levels bits of passes, which is enough for any step count that
+     * fits in 64 bits, throws std::out_of_range beyond them
+     */
+    [[nodiscard]] auto after_passes(std::uint32_t node,
+                                    std::uint64_t passes) const
+      -> std::uint32_t;
+
+    // the node reached from node after the given number of steps
+    [[nodiscard]] auto after_steps(graph const& g,
+                                   std::span<instruction const> instructions,
+                                   std::uint32_t node,
+                                   std::uint64_t steps) const -> std::uint32_t;
+
+    /* steps from node to the first end node, std::nullopt when none is ever
+     * reached, throws std::overflow_error when it is more than 64 bits away
+     */
+    [[nodiscard]] auto first_hit(std::uint32_t node) const
+      -> std::optional<std::uint64_t>;
+
+    [[nodiscard]] auto cycle_of(std::uint32_t node) const -> walk_cycle;
+  };
+
+  /* first step at which every walk stands on an end node, solved by a
+   * generalized chinese remainder over the cycles, std::nullopt when there
+   * is none, throws std::overflow_error when it does not fit in 64 bits
+   */
+  auto first_meeting(std::span<walk_cycle const> walks)
+    -> std::optional<std::uint64_t>;
+
+  /* network = the instructions and the graph they walk
+   * where:
+   *  storage owns the instructions, a vector when they were parsed and the
+   *  mapping of the whole file when they come from a snapshot
+   */
+  struct network {
+    std::span<instruction const> instructions;
+    graph nodes;
+    std::shared_ptr<void const> storage;
+
+    static auto from_stream(std::istream& input) -> network;
+
+    /* maps a snapshot back with no parsing, only the bounds are checked
+     * throws std::runtime_error when the file cannot be mapped or is not a
+     * valid snapshot
+     */
+    static auto from_snapshot(std::string const& path) -> network;
+
+    /* snapshot = the network as flat arrays in native byte order
+     * where:
+     *  the header holds a magic, a version, the node and instruction counts
+     *  the instruction bytes, the names and the links follow, each array
+     *  starting on a 4 byte boundary
+     */
+    auto write_snapshot(std::ostream& output) const -> void;
+  };
+
+  auto solve(network const& net)
+    -> std::pair<std::function<std::string()>,
+                 std::function<std::string()>> const;
+
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>,
                  std::function<std::string()>> const;
@@ -46,7 +222,16 @@ namespace std {
 
     template <typename FormatContext>
     auto format(const aoc::day8::graph& g, FormatContext& ctx) const {
-      return std::format_to(ctx.out(), "{}", g.nodes);
+      auto entries =
+        std::views::iota(std::uint32_t { 0 }, g.size()) |
+        std::views::transform([&](std::uint32_t node) {
+          return aoc::day8::graph::entry {
+            aoc::day8::decode_name(g.names[node]),
+            { aoc::day8::decode_name(g.names[g.links[node]]),
+              aoc::day8::decode_name(g.names[g.links[g.size() + node]]) }
+          };
+        });
+      return std::format_to(ctx.out(), "{}", entries);
     }
   };
 
@@ -1,13 +1,20 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <istream>
 #include <utility>
+#include <vector>
 
 namespace aoc::day9 {
-  using report = std::vector<std::uint64_t>;
+  using report = std::vector<std::int64_t>;
 
-  auto interpolate(report const& r) -> std::uint64_t;
+  /* the value after the last one of the report, and the one before the
+   * first, both exact, throw std::overflow_error when it does not fit in
+   * 64 bits
+   */
+  auto interpolate(report const& r) -> std::int64_t;
+  auto interpolate_back(report const& r) -> std::int64_t;
 
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>,
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace aoc {
+  /* thread_pool = persistent work stealing pool
+   * where:
+   *  every worker owns a deque of tasks, it pops from the front of its own
+   *  deque and, when it is empty, steals from the back of the others
+   *  concurrent callers share the same workers, so they never oversubscribe
+   *  the machine, and a worker waiting on a nested call runs tasks meanwhile
+   */
+  class thread_pool {
+  public:
+    explicit thread_pool(size_t num_workers);
+    ~thread_pool();
+
+    thread_pool(thread_pool const&) = delete;
+    auto operator=(thread_pool const&) -> thread_pool& = delete;
+
+    // process wide pool, one worker per hardware thread
+    static auto shared() -> thread_pool&;
+
+    [[nodiscard]] auto size() const -> size_t { return workers.size(); }
+
+    /* index of the calling thread in [0, size()) when it is a worker of this
+     * pool, size() for any other thread
+     */
+    [[nodiscard]] auto worker_index() const -> size_t;
+
+    /* calls body(begin, end) over chunks covering [0, count) and waits for
+     * all of them, chunks are at least min_grain long and there are a few per
+     * worker so that stealing can balance them. small ranges run inline
+     * when chunks throw, the first exception is rethrown once all of them
+     * are done
+     */
+    auto parallel_for(size_t count, size_t min_grain,
+                      std::function<void(size_t, size_t)> const& body) -> void;
+
+  private:
+    struct task_queue {
+      std::mutex mutex;
+      std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<task_queue>> queues;
+    std::atomic<size_t> queued = 0;
+    std::atomic<size_t> next_queue = 0;
+    std::mutex sleep_mutex;
+    std::condition_variable_any wake;
+    std::vector<std::jthread> workers;
+
+    auto push(std::function<void()> task) -> void;
+    auto try_pop(size_t index) -> std::optional<std::function<void()>>;
+    auto worker_loop(std::stop_token const& stop, size_t index) -> void;
+  };
+} // namespace aoc
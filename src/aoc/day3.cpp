@@ -1,15 +1,19 @@
-#include <aoc/dayn.hpp>
+#include <aoc/day3.hpp>
+#include <aoc/thread_pool.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <cstdint>
 #include <functional>
 #include <iostream>
 #include <istream>
-#include <map>
+#include <memory>
 #include <numeric>
 #include <print>
 #include <ranges>
-#include <set>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -48,119 +52,409 @@ namespace aoc::day3 {
    */
   using symbol = std::pair<char, point>;
 
-  auto parse_engine(std::istream& input)
-    -> std::pair<std::vector<number_part>, std::vector<symbol>> {
+  /* label_set = a tiny inline set of number labels
+   *
+   * a cell has at most 8 neighbors, so the labels adjacent to a symbol always
+   * fit in a fixed array and dedup is a linear scan over at most 8 entries
+   */
+  struct label_set {
+    std::array<std::int32_t, 8> labels {};
+    std::uint8_t size = 0;
+
+    auto insert(std::int32_t label) -> void {
+      for (std::uint8_t k = 0; k < size; k++) {
+        if (labels[k] == label) {
+          return;
+        }
+      }
+      labels[size++] = label;
+    }
+
+    [[nodiscard]] auto begin() const { return labels.begin(); }
+    [[nodiscard]] auto end() const { return labels.begin() + size; }
+  };
 
-    std::vector<number_part> number_parts;
+  /* engine = label image of the schematic
+   * where:
+   *  labels is a row-major width * height grid, each cell holds the index in
+   *  numbers of the number that occupies it (or no_label)
+   *  numbers is the table of all the number parts
+   *  symbols are all the cells that are neither a '.' nor a digit
+   */
+  struct engine {
+    static constexpr std::int32_t no_label = -1;
+
+    size_t width = 0;
+    size_t height = 0;
+    std::vector<std::int32_t> labels;
+    std::vector<number_part> numbers;
     std::vector<symbol> symbols;
 
-    auto lines = std::ranges::istream_view<std::string>(input) |
+    static auto from_rows(std::vector<std::string> const& rows) -> engine;
+
+    [[nodiscard]] auto label_at(size_t i, size_t j) const -> std::int32_t {
+      // out of bounds points wrap around to huge values, so one check is enough
+      if (i >= height || j >= width) {
+        return no_label;
+      }
+      return labels[i * width + j];
+    }
+
+    [[nodiscard]] auto adjacent_labels(point const& pos) const -> label_set {
+      auto const& [i, j] = pos;
+      label_set adjacent;
+      for (auto const& [di, dj] :
+           std::array<std::pair<int, int>, 8> { { { -1, -1 },
+                                                  { -1, 0 },
+                                                  { -1, 1 },
+                                                  { 0, -1 },
+                                                  { 0, 1 },
+                                                  { 1, -1 },
+                                                  { 1, 0 },
+                                                  { 1, 1 } } }) {
+        auto label = label_at(i + di, j + dj);
+        if (label != no_label) {
+          adjacent.insert(label);
+        }
+      }
+      return adjacent;
+    }
+  };
+
+  auto read_schematic(std::istream& input) -> std::vector<std::string> {
+    return std::ranges::istream_view<std::string>(input) |
       std::ranges::to<std::vector<std::string>>();
+  }
 
-    for (size_t i = 0; i < lines.size(); i++) {
-      auto line = lines[i];
+  auto engine::from_rows(std::vector<std::string> const& rows) -> engine {
+    engine e;
+    e.height = rows.size();
+    for (auto const& row : rows) {
+      e.width = std::max(e.width, row.size());
+    }
+    e.labels.assign(e.width * e.height, no_label);
+
+    for (size_t i = 0; i < rows.size(); i++) {
+      auto const& line = rows[i];
       for (size_t j = 0; j < line.size(); j++) {
         auto c = line[j];
         /* if c is a '.' => skip
          * if c is a digit => parse the number (all digits until a non-digit)
+         *  and label all of its cells
          * otherwise => add to symbols
          */
         if (c == '.') {
           continue;
         } else if (std::isdigit(c)) {
-          /* parse the number */
+          auto label = static_cast<std::int32_t>(e.numbers.size());
           size_t start = j;
-          size_t end = j;
-          while (end < line.size() && std::isdigit(line[end])) {
-            end++;
+          std::uint32_t number = 0;
+          for (; j < line.size() && std::isdigit(line[j]); j++) {
+            number = number * 10 + (line[j] - '0');
+            e.labels[i * e.width + j] = label;
           }
-          j = end - 1;
-          auto number = std::stoull(line.substr(start, end - start));
-          number_parts.push_back({ number, { i, { start, end - 1 } } });
+          e.numbers.push_back({ number, { i, { start, j - 1 } } });
+          j--;
         } else {
-          symbols.push_back({ c, { i, j } });
+          e.symbols.push_back({ c, { i, j } });
         }
       }
     }
-    return { number_parts, symbols };
+    return e;
   }
 
-  auto solution(std::istream& input)
-    -> std::pair<std::function<std::string()>, std::function<std::string()>> {
-    auto [number_parts, symbols] = parse_engine(input);
-
-    std::map<point, number_part> number_parts_map;
-    std::map<symbol, std::set<number_part>> symbol_number_parts_map;
-
-    /* for each number, add it to the grid
-     * where the grid is a map from point to interval
-     */
-    for (auto& part : number_parts) {
-      auto& [number, interval] = part;
-      auto& [i, range] = interval;
-      auto& [j1, j2] = range;
-      for (size_t j = j1; j <= j2; j++) {
-        number_parts_map[{ i, j }] = part;
+  /* row window helpers, rows may have different widths and a missing row is
+   * just an empty string_view
+   */
+  auto is_digit_at(std::string_view row, size_t j) -> bool {
+    return j < row.size() && std::isdigit(row[j]);
+  }
+
+  auto is_symbol_at(std::string_view row, size_t j) -> bool {
+    return j < row.size() && row[j] != '.' && !std::isdigit(row[j]);
+  }
+
+  /* resolves the row cur given its upper (prev) and lower (next) neighbors,
+   * only the numbers and the '*'s that live in cur are accounted for here,
+   * so every number and gear is counted by exactly one row
+   */
+  auto scan_row(std::string_view prev, std::string_view cur,
+                std::string_view next) -> totals {
+    totals row_totals;
+
+    for (size_t j = 0; j < cur.size(); j++) {
+      if (is_digit_at(cur, j)) {
+        /* parse the number, then look for a symbol in the box around it
+         * (the columns j1 - 1 to j2 + 1 of the 3 rows)
+         */
+        size_t start = j;
+        std::uint64_t number = 0;
+        for (; is_digit_at(cur, j); j++) {
+          number = number * 10 + (cur[j] - '0');
+        }
+        bool touches_symbol = false;
+        for (auto col = start == 0 ? 0 : start - 1; col <= j; col++) {
+          touches_symbol = touches_symbol || is_symbol_at(prev, col) ||
+            is_symbol_at(cur, col) || is_symbol_at(next, col);
+        }
+        if (touches_symbol) {
+          row_totals.part_numbers += number;
+        }
+        j--;
+      } else if (cur[j] == '*') {
+        /* collect the distinct numbers around the gear, in each row the
+         * digits of the 3 columns may all belong to the same number
+         */
+        size_t count = 0;
+        std::uint64_t ratio = 1;
+        for (auto row : { prev, cur, next }) {
+          auto first = j == 0 ? 0 : j - 1;
+          for (auto col = first; col <= j + 1; col++) {
+            if (!is_digit_at(row, col) ||
+                (col != first && is_digit_at(row, col - 1))) {
+              continue;
+            }
+            auto start = col;
+            while (start != 0 && is_digit_at(row, start - 1)) {
+              start--;
+            }
+            std::uint64_t number = 0;
+            for (auto end = start; is_digit_at(row, end); end++) {
+              number = number * 10 + (row[end] - '0');
+            }
+            count++;
+            ratio *= number;
+          }
+        }
+        if (count == 2) {
+          row_totals.gear_ratios += ratio;
+        }
+      }
+    }
+    return row_totals;
+  }
+
+  auto label_totals(std::vector<std::string> const& rows) -> totals {
+    auto const schematic = engine::from_rows(rows);
+    totals result;
+
+    // a number is a part as soon as one symbol sees its label
+    std::vector<bool> is_part(schematic.numbers.size(), false);
+    for (auto const& [c, pos] : schematic.symbols) {
+      auto adjacent = schematic.adjacent_labels(pos);
+      for (auto label : adjacent) {
+        is_part[label] = true;
+      }
+      // a gear is all '*'s witch has 2 neighbors
+      if (c == '*' && adjacent.size == 2) {
+        result.gear_ratios +=
+          std::accumulate(adjacent.begin(), adjacent.end(), 1ull,
+                          [&](auto acc, auto label) {
+                            return acc * schematic.numbers[label].first;
+                          });
+      }
+    }
+    for (size_t label = 0; label < schematic.numbers.size(); label++) {
+      if (is_part[label]) {
+        result.part_numbers += schematic.numbers[label].first;
+      }
+    }
+    return result;
+  }
+
+  auto scan(std::istream& input,
+            std::function<void(size_t, totals const&)> const& on_row)
+    -> totals {
+    totals running;
+    std::string prev, cur, next;
+    size_t row = 0;
+
+    auto resolve = [&]() {
+      auto [part_numbers, gear_ratios] = scan_row(prev, cur, next);
+      running.part_numbers += part_numbers;
+      running.gear_ratios += gear_ratios;
+      if (on_row) {
+        on_row(row, running);
+      }
+      row++;
+    };
+
+    if (!(input >> cur)) {
+      return running;
+    }
+    while (input >> next) {
+      resolve();
+      prev = std::exchange(cur, std::move(next));
+      next.clear();
+    }
+    resolve();
+
+    return running;
+  }
+
+  /* bands shorter than this are not worth a task of their own, the pool runs
+   * schematics with fewer rows inline
+   */
+  constexpr size_t min_band_rows = 256;
+
+  /* runs band(b0, b1) over row bands on the shared pool and adds up their
+   * totals, each band owns the rows b0 to b1 (exclusive) and reads one halo
+   * row on each side, a number or a gear is only counted by the band owning
+   * its row, so numbers across band edges are counted once and gears
+   * touching numbers of other bands still see them through the halo rows
+   */
+  auto scan_parallel(size_t rows,
+                     std::function<totals(size_t, size_t)> const& band)
+    -> totals {
+    // one total per worker (plus the caller), each on its own cache line
+    struct alignas(64) padded_totals {
+      totals value;
+    };
+
+    auto& pool = thread_pool::shared();
+    std::vector<padded_totals> band_totals(pool.size() + 1);
+    pool.parallel_for(rows, min_band_rows, [&](size_t b0, size_t b1) {
+      auto [part_numbers, gear_ratios] = band(b0, b1);
+      auto& local = band_totals[pool.worker_index()].value;
+      local.part_numbers += part_numbers;
+      local.gear_ratios += gear_ratios;
+    });
+
+    // merge step: the bands are disjoint, so their totals just add up
+    return std::accumulate(std::begin(band_totals), std::end(band_totals),
+                           totals {},
+                           [](totals acc, padded_totals const& band) {
+                             acc.part_numbers += band.value.part_numbers;
+                             acc.gear_ratios += band.value.gear_ratios;
+                             return acc;
+                           });
+  }
+
+  auto scan_bands(std::vector<std::string> const& rows) -> totals {
+    return scan_parallel(rows.size(), [&rows](size_t b0, size_t b1) {
+      totals local;
+      for (auto i = b0; i < b1; i++) {
+        auto [part_numbers, gear_ratios] =
+          scan_row(i > 0 ? std::string_view { rows[i - 1] } : "", rows[i],
+                   i + 1 < rows.size() ? std::string_view { rows[i + 1] }
+                                       : "");
+        local.part_numbers += part_numbers;
+        local.gear_ratios += gear_ratios;
       }
+      return local;
+    });
+  }
+
+  /* symbol_mask = one bit per column of a row, bit j % 64 of word j / 64 is
+   * set when the column j holds a symbol
+   */
+  using symbol_mask = std::vector<std::uint64_t>;
+
+  /* dilates a mask by one column to each side, the bits shifted out of a
+   * word are carried into its neighbor words
+   */
+  auto dilate(symbol_mask const& mask) -> symbol_mask {
+    symbol_mask dilated(mask.size());
+    for (size_t w = 0; w < mask.size(); w++) {
+      dilated[w] = mask[w] | (mask[w] << 1) | (mask[w] >> 1) |
+        (w > 0 ? mask[w - 1] >> 63 : 0) |
+        (w + 1 < mask.size() ? mask[w + 1] << 63 : 0);
     }
+    return dilated;
+  }
 
-    /* for each symbol, find its 8-neighbors
-     * then, for each neighbor, get the number part
-     * then, add the number part to the symbol's set
-     */
-    for (auto& symbol : symbols) {
-      auto& [c, pos] = symbol;
-      auto& [i, j] = pos;
-      // there will be invalid points, but that's ok
-      std::vector<point> neighbors = { { i - 1, j - 1 }, { i - 1, j },
-                                       { i - 1, j + 1 }, { i, j - 1 },
-                                       { i, j + 1 },     { i + 1, j - 1 },
-                                       { i + 1, j },     { i + 1, j + 1 } };
-      auto unique_entries = neighbors |
-        std::ranges::views::filter([&](auto& p) {
-                              return number_parts_map.contains(p);
-                            }) |
-        std::views::transform([&](auto& p) { return number_parts_map.at(p); }) |
-        std::ranges::to<std::set<std::pair<std::uint32_t, interval>>>();
-      symbol_number_parts_map[symbol] = unique_entries;
+  /* tests the columns j1 to j2 (inclusive) against a mask, 64 columns per
+   * word and-ed at once
+   */
+  auto intersects(symbol_mask const& mask, size_t j1, size_t j2) -> bool {
+    for (auto w = j1 / 64; w <= j2 / 64; w++) {
+      auto lo = w == j1 / 64 ? j1 % 64 : 0;
+      auto hi = w == j2 / 64 ? j2 % 64 : 63;
+      auto span = (~0ull >> (63 - hi)) & (~0ull << lo);
+      if (mask[w] & span) {
+        return true;
+      }
     }
+    return false;
+  }
 
-    auto pt1 = [=]() {
-      /* sum all the numbers_part.first in the set of each symbol entry in the
-       * symbol_number_parts_map*/
-      auto sum = std::accumulate(
-        symbol_number_parts_map.begin(), symbol_number_parts_map.end(), 0ull,
-        [](auto acc, auto& entry) {
-          auto& [symbol, number_parts] = entry;
-          return acc +
-            std::accumulate(number_parts.begin(), number_parts.end(), 0ull,
-                            [](auto acc, auto& number_part) {
-                              auto& [number, interval] = number_part;
-                              return acc + number;
-                            });
-        });
-      return std::to_string(sum);
+  auto row_mask(std::string const& row, size_t words) -> symbol_mask {
+    symbol_mask mask(words, 0);
+    for (size_t j = 0; j < row.size(); j++) {
+      mask[j / 64] |= static_cast<std::uint64_t>(is_symbol_at(row, j))
+        << (j % 64);
+    }
+    return mask;
+  }
+
+  /* part 1 kernel: builds a symbol mask per row, ors it with the rows above
+   * and below, dilates it horizontally and then each number only needs its
+   * span tested against the dilated mask of its own row
+   * the masks of the rows b0 - 1 to b1 are rolled three at a time, so the
+   * row bands of the pool each build their own halo masks
+   */
+  auto part_number_sum(std::vector<std::string> const& rows) -> std::uint64_t {
+    size_t width = 0;
+    for (auto const& row : rows) {
+      width = std::max(width, row.size());
+    }
+    auto words = (width + 63) / 64;
+
+    auto mask_of = [&](size_t i) {
+      return i < rows.size() ? row_mask(rows[i], words) : symbol_mask(words);
     };
 
+    auto band = [&](size_t b0, size_t b1) {
+      totals local;
+      if (b0 == b1) {
+        return local;
+      }
+      auto above = b0 > 0 ? mask_of(b0 - 1) : symbol_mask(words);
+      auto current = mask_of(b0);
+      symbol_mask neighborhood(words);
+      for (auto i = b0; i < b1; i++) {
+        auto below = mask_of(i + 1);
+        for (size_t w = 0; w < words; w++) {
+          neighborhood[w] = above[w] | current[w] | below[w];
+        }
+        auto dilated = dilate(neighborhood);
+
+        auto const& row = rows[i];
+        for (size_t j = 0; j < row.size(); j++) {
+          if (!is_digit_at(row, j)) {
+            continue;
+          }
+          size_t start = j;
+          std::uint64_t number = 0;
+          for (; is_digit_at(row, j); j++) {
+            number = number * 10 + (row[j] - '0');
+          }
+          if (intersects(dilated, start, j - 1)) {
+            local.part_numbers += number;
+          }
+        }
+        above = std::exchange(current, std::move(below));
+      }
+      return local;
+    };
+
+    return scan_parallel(rows.size(), band).part_numbers;
+  }
+
+  auto solution(std::istream& input)
+    -> std::pair<std::function<std::string()>, std::function<std::string()>> {
+    constexpr size_t parallel_threshold = 4096;
+    auto const rows =
+      std::make_shared<const std::vector<std::string>>(read_schematic(input));
+
+    auto pt1 = [=]() { return std::to_string(part_number_sum(*rows)); };
+
     auto pt2 = [=]() {
-      // a gear is all '*'s witch has 2 neighbors
-      auto gears =
-        symbol_number_parts_map | std::ranges::views::filter([&](auto& entry) {
-          auto& [symbol, number_parts] = entry;
-          return symbol.first == '*' && number_parts.size() == 2;
-        }) |
-        std::views::transform([&](auto& entry) {
-          auto& [symbol, number_parts] = entry;
-          return std::accumulate(number_parts.begin(), number_parts.end(), 1ull,
-                                 [](auto acc, auto& number_part) {
-                                   auto& [number, interval] = number_part;
-                                   return acc * number;
-                                 });
-        }) |
-        std::ranges::to<std::vector<std::uint32_t>>();
-      // sum all the gears
-      auto sum = std::accumulate(gears.begin(), gears.end(), 0ull);
-      return std::to_string(sum);
+      // big schematics are split in row bands on the shared pool
+      if (rows->size() >= parallel_threshold) {
+        return std::to_string(scan_bands(*rows).gear_ratios);
+      }
+      return std::to_string(label_totals(*rows).gear_ratios);
     };
     return { pt1, pt2 };
   }
@@ -1,105 +1,153 @@
 #include <algorithm>
-#include <aoc/dayn.hpp>
+#include <aoc/day4.hpp>
 
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
 #include <forward_list>
 #include <functional>
 #include <iostream>
 #include <istream>
 #include <iterator>
-#include <map>
-#include <numeric>
+#include <optional>
 #include <print>
 #include <ranges>
-#include <set>
-#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
 
 namespace aoc::day4 {
+  /* card numbers are all in 0..127, so each side of a card is a 128 bit mask
+   * and the hits are just popcount(winning & numbers)
+   */
+  using number_mask = std::bitset<128>;
+
+  auto parse_numbers(std::string_view str) -> number_mask {
+    number_mask mask;
+    std::optional<size_t> number;
+    for (auto c : str) {
+      if (std::isdigit(c)) {
+        number = number.value_or(0) * 10 + (c - '0');
+      } else if (number) {
+        mask.set(*number);
+        number.reset();
+      }
+    }
+    if (number) {
+      mask.set(*number);
+    }
+    return mask;
+  }
+
   struct Cards {
     int id;
-    std::set<int> winning_numbers;
-    std::set<int> numbers;
+    number_mask winning_numbers;
+    number_mask numbers;
 
     auto friend operator>>(std::istream& input, Cards& cards) -> std::istream& {
-      cards.winning_numbers.clear();
-      cards.numbers.clear();
+      cards.winning_numbers.reset();
+      cards.numbers.reset();
 
-      std::string winning_line, numbers_line, tmp;
-      std::getline(input, tmp, ':');
-      std::getline(input, winning_line, '|');
-      std::getline(input, numbers_line);
-
-      if (winning_line.empty() || numbers_line.empty()) {
+      std::string line;
+      if (!std::getline(input, line)) {
         return input;
       }
 
-      std::istringstream winning_stream(winning_line),
-        numbers_stream(numbers_line), tmp_stream(tmp);
-
-      tmp_stream >> tmp >> cards.id;
-
-      for (int number; winning_stream >> number;) {
-        cards.winning_numbers.insert(number);
+      auto colon = line.find(':');
+      auto bar = line.find('|', colon);
+      if (colon == std::string::npos || bar == std::string::npos) {
+        input.setstate(std::ios::failbit);
+        return input;
       }
 
-      for (int number; numbers_stream >> number;) {
-        cards.numbers.insert(number);
-      }
+      auto view = std::string_view { line };
+      auto id = view.substr(0, colon);
+      id.remove_prefix(std::min(id.find_first_of("0123456789"), id.size()));
+      std::from_chars(id.data(), id.data() + id.size(), cards.id);
+
+      cards.winning_numbers =
+        parse_numbers(view.substr(colon + 1, bar - colon - 1));
+      cards.numbers = parse_numbers(view.substr(bar + 1));
 
       return input;
     }
 
     auto friend operator<<(std::ostream& output, const Cards& game)
       -> std::ostream& {
+      auto print_mask = [&](number_mask const& mask) {
+        for (size_t number = 0; number < mask.size(); number++) {
+          if (mask.test(number)) {
+            output << number << " ";
+          }
+        }
+      };
+
       output << "[Cards]"
              << " id: " << game.id << std::endl
              << "\t[winning]: ";
-      std::ranges::copy(game.winning_numbers,
-                        std::ostream_iterator<int>(output, " "));
+      print_mask(game.winning_numbers);
       output << std::endl << "\t[numbers]: ";
-      std::ranges::copy(game.numbers, std::ostream_iterator<int>(output, " "));
+      print_mask(game.numbers);
 
       return output;
     }
     [[nodiscard]] auto number_of_hits() const -> int {
-      return std::ranges::count_if(numbers, [this](int number) {
-        return winning_numbers.contains(number);
-      });
+      return static_cast<int>((winning_numbers & numbers).count());
     }
   };
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>, std::function<std::string()>> {
 
+    /* a card is worth 2^(hits - 1) points, the 128 bit masks allow up to 128
+     * hits but the points are summed in 64 bits, so any card or total
+     * beyond that throws std::overflow_error
+     */
     auto pt1 = [&]() -> std::string {
-      auto cards = std::views::istream<Cards>(input);
-      auto winning = cards | std::views::transform([](const Cards& cards) {
-                       auto hits = cards.number_of_hits();
-                       return std::max(std::pow(2, hits - 1), 0.0);
-                     }) |
-        std::ranges::to<std::vector<int>>();
-      auto sum = std::accumulate(std::begin(winning), std::end(winning), 0);
+      std::uint64_t sum = 0;
+      for (const auto& card : std::views::istream<Cards>(input)) {
+        auto hits = card.number_of_hits();
+        if (hits > 64) {
+          throw std::overflow_error("card " + std::to_string(card.id) +
+                                    " is worth more than 2^63 points");
+        }
+        auto points = hits == 0 ? 0ull : 1ull << (hits - 1);
+        if (__builtin_add_overflow(sum, points, &sum)) {
+          throw std::overflow_error("points do not fit in 64 bits");
+        }
+      }
       return std::to_string(sum);
     };
 
     auto pt2 = [&]() -> std::string {
-      auto cards = std::views::istream<Cards>(input) |
-        std::ranges::to<std::vector<Cards>>();
-      auto cards_copies = cards | std::views::transform([](const Cards& card) {
-                            return std::pair(card.id, 1);
-                          }) |
-        std::ranges::to<std::map<int, int>>();
-
-      for (const auto& card : cards) {
-        auto id = card.id;
-        auto copies = cards_copies[id];
-        auto hits = card.number_of_hits();
-        for (auto j = id + 1; j <= id + hits && j <= cards.size(); j++) {
-          cards_copies[j] += copies;
+      /* difference ring: a card won by the current one adds its copies to the
+       * next hits cards, which is a +copies at the next card and a -copies
+       * right after the last one. a card wins at most number_mask::size()
+       * cards ahead, so a ring a bit bigger than that never wraps onto a
+       * pending entry and every card is finalized as soon as it is read
+       */
+      std::array<std::int64_t, 2 * number_mask {}.size()> pending {};
+      std::int64_t won = 0;
+      std::uint64_t sum = 0;
+      size_t position = 0;
+
+      for (const auto& card : std::views::istream<Cards>(input)) {
+        auto slot = [&](size_t ahead) -> auto& {
+          return pending[(position + ahead) % pending.size()];
+        };
+        won += std::exchange(slot(0), 0);
+        auto copies = 1 + won;
+        sum += copies;
+
+        auto hits = static_cast<size_t>(card.number_of_hits());
+        if (hits > 0) {
+          slot(1) += copies;
+          slot(hits + 1) -= copies;
         }
+        position++;
       }
-      auto sum = std::accumulate(
-        std::begin(cards_copies), std::end(cards_copies), 0,
-        [](int acc, const auto& card) { return acc + card.second; });
       return std::to_string(sum);
     };
     return { pt1, pt2 };
@@ -1,109 +1,114 @@
 #include <aoc/day5.hpp>
+#include <aoc/thread_pool.hpp>
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <concepts>
 #include <cstdint>
 #include <functional>
 #include <ios>
 #include <iostream>
 #include <istream>
 #include <limits>
-#include <map>
+#include <numeric>
+#include <optional>
 #include <print>
 #include <ranges>
 #include <regex>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
-#include <thread>
+#include <system_error>
 #include <utility>
 #include <vector>
 
 namespace aoc::day5 {
-  using range = std::pair<std::uint32_t, std::uint32_t>;
-  using entry = std::pair<std::uint32_t, range>;
-
-  class interval_map {
-    std::map<std::uint32_t, range> map;
-    interval_map(std::map<std::uint32_t, range> init_map)
-      : map(std::move(init_map)) {}
-
-  public:
-    static auto from_entries(std::vector<entry>&& entries) -> interval_map;
-    [[nodiscard]] auto search(std::uint32_t key) const -> std::uint32_t;
-  };
-
-  class almanac {
-    almanac(std::vector<std::uint32_t> seeds, std::vector<interval_map> maps)
-      : seeds(std::move(seeds)), maps(std::move(maps)) {}
-
-  public:
-    std::vector<std::uint32_t> seeds;
-    std::vector<interval_map> maps;
-
-    auto static from_str(const std::string&& str) -> almanac;
-
-    [[nodiscard]] auto map_seeds(const std::vector<std::uint32_t>& seeds) const
-      -> std::uint32_t {
-      const size_t num_threads =
-        std::max(1u, std::thread::hardware_concurrency());
-      const size_t chunk_size = seeds.size() / num_threads;
-      std::vector<std::thread> threads;
-      std::vector<std::uint32_t> min_results(
-        num_threads, std::numeric_limits<std::uint32_t>::max());
-
-      for (size_t i = 0; i < num_threads; ++i) {
-        size_t start_index = i * chunk_size;
-        size_t end_index =
-          (i == num_threads - 1) ? seeds.size() : (i + 1) * chunk_size;
-
-        threads.emplace_back(
-          [this, &seeds, start_index, end_index, &min_results, i]() {
-            for (size_t j = start_index; j < end_index; ++j) {
-              std::uint32_t result = seeds[j];
-              for (const auto& map : maps) {
-                result = map.search(result);
-              }
-              min_results[i] = std::min(min_results[i], result);
-            }
-          });
-      }
+  namespace {
+    /* whether the almanac text can be solved in T: every value, and the
+     * (exclusive) end of every seed range and map entry, fits in it. max(T)
+     * is then never a location, so it stays free for the no seed sentinel
+     */
+    template <std::unsigned_integral T>
+    auto fits_in(std::string_view str) -> bool {
+      constexpr wide_t<T> max = std::numeric_limits<T>::max();
+      std::istringstream lines { std::string { str } };
+      for (std::string line; std::getline(lines, line);) {
+        std::vector<wide_t<T>> values;
+        for (auto const* it = line.data(); it != line.data() + line.size();) {
+          if (!std::isdigit(static_cast<unsigned char>(*it))) {
+            it++;
+            continue;
+          }
+          std::uint64_t value;
+          auto [end, error] =
+            std::from_chars(it, line.data() + line.size(), value);
+          if (error != std::errc {} || value >= max) {
+            return false;
+          }
+          values.push_back(value);
+          it = end;
+        }
 
-      for (auto& thread : threads) {
-        if (thread.joinable()) {
-          thread.join();
+        if (line.starts_with("seeds:")) {
+          for (size_t i = 0; i + 1 < values.size(); i += 2) {
+            if (values[i] + values[i + 1] > max) {
+              return false;
+            }
+          }
+        } else if (values.size() == 3) {
+          auto size = values[2];
+          if (values[0] + size > max || values[1] + size > max) {
+            return false;
+          }
         }
       }
-
-      return *std::min_element(min_results.begin(), min_results.end());
+      return true;
     }
-  };
 
-  auto solution(std::istream& input)
-    -> std::pair<std::function<std::string()>, std::function<std::string()>> {
-    const auto str = std::string { std::istreambuf_iterator<char> { input },
-                                   std::istreambuf_iterator<char> {} };
-    const auto almanac = almanac::from_str(std::move(str));
+    template <std::unsigned_integral T>
+    auto solve(std::string str)
+      -> std::pair<std::function<std::string()>,
+                   std::function<std::string()>> {
+      const auto almanac = basic_almanac<T>::from_str(std::move(str));
 
-    const auto pt1 = [=]() {
-      return std::to_string(almanac.map_seeds(almanac.seeds));
-    };
+      // no seed at all reads as the 64 bit sentinel whatever the width
+      auto location = [](T value) {
+        return std::to_string(value == std::numeric_limits<T>::max()
+                                ? std::numeric_limits<std::uint64_t>::max()
+                                : std::uint64_t { value });
+      };
 
-    const auto pt2 = [=]() {
-      auto pairs = std::views::iota(0u, almanac.seeds.size() / 2) |
-        std::views::transform([=](auto i) {
-                     auto first = almanac.seeds[i * 2];
-                     auto count = almanac.seeds[i * 2 + 1];
-                     return std::views::iota(first, first + count);
-                   }) |
-        std::views::join | std::views::common | std::ranges::to<std::vector>();
+      const auto pt1 = [=]() {
+        return location(almanac.map_seeds(almanac.seeds));
+      };
 
-      return std::to_string(almanac.map_seeds(pairs));
-    };
+      const auto pt2 = [=]() {
+        return location(almanac.map_intervals(almanac.seed_intervals()));
+      };
+
+      return { pt1, pt2 };
+    }
+  } // namespace
 
-    return { pt1, pt2 };
+  auto solution(std::istream& input)
+    -> std::pair<std::function<std::string()>, std::function<std::string()>> {
+    auto str = std::string { std::istreambuf_iterator<char> { input },
+                             std::istreambuf_iterator<char> {} };
+    // the 32 bit almanac keeps twice the lanes per batched lookup
+    if (fits_in<std::uint32_t>(str)) {
+      return solve<std::uint32_t>(std::move(str));
+    }
+    return solve<std::uint64_t>(std::move(str));
   }
 
-  auto operator>>(std::istream& input, entry& entry) -> std::istream& {
+  template <std::unsigned_integral T>
+  auto operator>>(std::istream& input, basic_entry<T>& entry)
+    -> std::istream& {
     input >> entry.second.first;
     input >> entry.first;
     input >> entry.second.second;
@@ -112,17 +117,20 @@ namespace aoc::day5 {
   }
 
   // almanac implementation
-  auto almanac::from_str(const std::string&& str) -> almanac {
+  template <std::unsigned_integral T>
+  auto basic_almanac<T>::from_str(const std::string&& str) -> basic_almanac {
+    constexpr wide_t<T> domain_end =
+      wide_t<T> { std::numeric_limits<T>::max() } + 1;
 
     std::stringstream stream { str };
     std::string chunk;
 
-    std::vector<std::uint32_t> seeds;
+    std::vector<T> seeds;
 
     stream.ignore(std::numeric_limits<std::streamsize>::max(), ':');
     std::getline(stream, chunk);
     std::stringstream line_stream { chunk };
-    std::ranges::copy(std::ranges::istream_view<std::uint32_t>(line_stream),
+    std::ranges::copy(std::ranges::istream_view<T>(line_stream),
                       std::back_inserter(seeds));
 
     // parsing maps (each map delimiter is a blank line)
@@ -137,8 +145,13 @@ namespace aoc::day5 {
         auto stream = std::stringstream { str };
         // ignore first line
         stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        std::vector<entry> entries;
-        for (entry e; stream >> e;) {
+        std::vector<basic_entry<T>> entries;
+        for (basic_entry<T> e; stream >> e;) {
+          auto const& [src, dst] = e;
+          if (wide_t<T> { src } + dst.second > domain_end ||
+              wide_t<T> { dst.first } + dst.second > domain_end) {
+            throw std::overflow_error("map entry does not fit in the domain");
+          }
           entries.push_back(e);
         }
         return interval_map::from_entries(std::move(entries));
@@ -148,28 +161,324 @@ namespace aoc::day5 {
     return { seeds, maps };
   }
 
+  template <std::unsigned_integral T>
+  basic_almanac<T>::basic_almanac(std::vector<T> seeds,
+                                  std::vector<interval_map> maps)
+    : seeds(std::move(seeds)), maps(std::move(maps)),
+      fused(std::accumulate(std::begin(this->maps), std::end(this->maps),
+                            interval_map::from_entries({}),
+                            [](auto const& acc, auto const& map) {
+                              return acc.compose(map);
+                            })) {}
+
+  template <std::unsigned_integral T>
+  auto basic_almanac<T>::seed_intervals() const -> std::vector<interval> {
+    return std::views::iota(size_t { 0 }, seeds.size() / 2) |
+      std::views::transform([this](auto i) {
+             wide_t<T> first = seeds[i * 2];
+             wide_t<T> count = seeds[i * 2 + 1];
+             return interval { first, first + count };
+           }) |
+      std::views::filter([](auto const& i) { return i.first < i.second; }) |
+      std::ranges::to<std::vector<interval>>();
+  }
+
+  template <std::unsigned_integral T>
+  auto basic_almanac<T>::map_seeds(const std::vector<T>& seeds) const -> T {
+    /* below this many seeds the pool overhead is not worth it, above it
+     * chunks of at least serial_threshold / 4 seeds are handed to the pool
+     */
+    constexpr size_t serial_threshold = 1 << 16;
+
+    auto min_of = [this, &seeds](size_t begin, size_t end) {
+      std::array<T, 64 * interval_map::lanes> results;
+      auto min = std::numeric_limits<T>::max();
+      for (auto j = begin; j < end; j += results.size()) {
+        auto count = std::min(results.size(), end - j);
+        auto found = std::span { results }.first(count);
+        fused.search_many(std::span { seeds }.subspan(j, count), found);
+        // count is at least 1 here, so found is never empty
+        min = std::min(min, std::ranges::min(found));
+      }
+      return min;
+    };
+
+    if (seeds.size() < serial_threshold) {
+      return min_of(0, seeds.size());
+    }
+
+    // one minimum per worker (plus the caller), each on its own cache line
+    struct alignas(64) padded_min {
+      T value = std::numeric_limits<T>::max();
+    };
+
+    auto& pool = thread_pool::shared();
+    std::vector<padded_min> min_results(pool.size() + 1);
+    pool.parallel_for(seeds.size(), serial_threshold / 4,
+                      [&](size_t begin, size_t end) {
+                        auto& min = min_results[pool.worker_index()].value;
+                        min = std::min(min, min_of(begin, end));
+                      });
+
+    // there is always the caller's slot, so min_results is never empty
+    return std::ranges::min(min_results |
+                            std::views::transform(&padded_min::value));
+  }
+
+  template <std::unsigned_integral T>
+  auto basic_almanac<T>::map_intervals(
+    std::vector<interval> const& intervals) const -> T {
+    auto mapped = fused.map_intervals(intervals);
+    // no seed at all gives the same sentinel as map_seeds
+    if (mapped.empty()) {
+      return std::numeric_limits<T>::max();
+    }
+    /* the seed intervals are clamped to the domain and from_str keeps every
+     * entry inside it, so any mapped start fits in T
+     */
+    return static_cast<T>(std::ranges::min(mapped | std::views::keys));
+  }
+
+  template <std::unsigned_integral T>
+  auto basic_almanac<T>::lowest_location_inverse(
+    std::vector<interval> intervals) const -> std::optional<T> {
+    // sort and merge the seed intervals so they can be binary searched
+    std::ranges::sort(intervals);
+    std::vector<interval> merged;
+    for (auto const& [start, end] : intervals) {
+      if (!merged.empty() && start <= merged.back().second) {
+        merged.back().second = std::max(merged.back().second, end);
+      } else {
+        merged.emplace_back(start, end);
+      }
+    }
+    return fused.lowest_image_of(merged);
+  }
+
   // interval_map implementation
-  auto interval_map::from_entries(std::vector<entry>&& entries)
-    -> interval_map {
-    std::map<std::uint32_t, range> temp_map(
-      std::make_move_iterator(std::begin(entries)),
-      std::make_move_iterator(std::end(entries)));
-    return { std::move(temp_map) };
+  template <std::unsigned_integral T>
+  basic_interval_map<T>::basic_interval_map(
+    std::vector<entry> const& sorted_entries) {
+    for (auto const& [src, dst] : sorted_entries) {
+      src_starts.push_back(src);
+      dst_starts.push_back(dst.first);
+      sizes.push_back(dst.second);
+    }
+
+    auto count = sorted_entries.size();
+    depth = std::bit_width(count);
+    tree.assign(size_t { 1 } << depth, std::numeric_limits<T>::max());
+
+    // an in-order walk of the implicit tree visits the slots in sorted order
+    size_t next = 0;
+    auto fill = [&](auto& self, size_t k) -> void {
+      if (k >= tree.size()) {
+        return;
+      }
+      self(self, 2 * k);
+      if (next < count) {
+        tree[k] = sorted_entries[next].first;
+      }
+      next++;
+      self(self, 2 * k + 1);
+    };
+    fill(fill, 1);
   }
-  auto interval_map::search(std::uint32_t key) const -> std::uint32_t {
-    auto it = map.upper_bound(key);
-    if (it == std::begin(map)) {
-      return key;
+
+  template <std::unsigned_integral T>
+  auto basic_interval_map<T>::from_entries(std::vector<entry>&& entries)
+    -> basic_interval_map {
+    std::ranges::stable_sort(entries, {}, &entry::first);
+    auto [first, last] = std::ranges::unique(entries, {}, &entry::first);
+    entries.erase(first, last);
+    return { entries };
+  }
+
+  template <std::unsigned_integral T>
+  auto basic_interval_map<T>::rank(T key) const -> size_t {
+    size_t k = 1;
+    for (size_t level = 0; level < depth; level++) {
+      k = 2 * k + (tree[k] <= key);
     }
-    if (it != map.begin()) {
-      it--;
+    // padding slots compare <= only against the max key, clamp them away
+    return std::min(k - tree.size(), src_starts.size() - 1);
+  }
+
+  template <std::unsigned_integral T>
+  auto basic_interval_map<T>::search(T key) const -> T {
+    return resolve(rank(key), key);
+  }
+
+  template <std::unsigned_integral T>
+  auto basic_interval_map<T>::search_many(std::span<const T> keys,
+                                          std::span<T> results) const
+    -> void {
+    /* lanes keys walk down the tree in lock step, every level is a
+     * branchless compare per lane (vectorized by the compiler) and the
+     * nodes a few levels below, which share one cache line, are prefetched
+     */
+    const auto* nodes = tree.data();
+    for (size_t base = 0; base < keys.size(); base += lanes) {
+      auto count = std::min(lanes, keys.size() - base);
+
+      std::array<T, lanes> batch {};
+      std::ranges::copy(keys.subspan(base, count), std::begin(batch));
+      std::array<size_t, lanes> k;
+      k.fill(1);
+
+      for (size_t level = 0; level < depth; level++) {
+        for (size_t lane = 0; lane < lanes; lane++) {
+          k[lane] = 2 * k[lane] + (nodes[k[lane]] <= batch[lane]);
+          __builtin_prefetch(nodes +
+                             std::min(k[lane] * lanes, tree.size() - 1));
+        }
+      }
+
+      for (size_t lane = 0; lane < count; lane++) {
+        auto slot = std::min(k[lane] - tree.size(), src_starts.size() - 1);
+        results[base + lane] = resolve(slot, batch[lane]);
+      }
     }
-    auto& [src_range_start, dst] = *it;
-    auto& [dst_range_start, range_size] = dst;
-    if (key >= (src_range_start + range_size)) {
-      return key;
+  }
+
+  template <std::unsigned_integral T>
+  auto basic_interval_map<T>::map_intervals(
+    std::vector<interval> const& intervals) const -> std::vector<interval> {
+    std::vector<interval> mapped;
+    for (auto [start, end] : intervals) {
+      /* walk the interval from left to right, each step either consumes the
+       * part covered by the entry at cur (shifted to its destination) or the
+       * gap until the next entry (left as is)
+       */
+      end = std::min(end, domain_end);
+      for (auto cur = start; cur < end;) {
+        auto slot = rank(static_cast<T>(cur));
+        wide src_range_end = wide { src_starts[slot] } + sizes[slot];
+        if (cur < src_range_end) {
+          auto piece_end = std::min(end, src_range_end);
+          auto offset = cur - src_starts[slot];
+          mapped.emplace_back(dst_starts[slot] + offset,
+                              dst_starts[slot] + offset + (piece_end - cur));
+          cur = piece_end;
+          continue;
+        }
+        auto gap_end = slot + 1 == src_starts.size()
+          ? end
+          : std::min<wide>(end, src_starts[slot + 1]);
+        mapped.emplace_back(cur, gap_end);
+        cur = gap_end;
+      }
     }
-    return dst_range_start + (key - src_range_start);
+    return mapped;
   }
 
+  template <std::unsigned_integral T>
+  auto basic_interval_map<T>::compose(basic_interval_map const& next) const
+    -> basic_interval_map {
+    /* next(this(x)) is linear between consecutive breakpoints, which are the
+     * breakpoints of this plus the preimages (under this) of the breakpoints
+     * of next. extra breakpoints are harmless, so a breakpoint of next is
+     * always added as is (its preimage if it falls in a gap of this)
+     */
+    std::vector<wide> breakpoints { 0 };
+    for (size_t slot = 1; slot < src_starts.size(); slot++) {
+      breakpoints.push_back(src_starts[slot]);
+      breakpoints.push_back(wide { src_starts[slot] } + sizes[slot]);
+    }
+    for (size_t next_slot = 1; next_slot < next.src_starts.size();
+         next_slot++) {
+      wide next_src = next.src_starts[next_slot];
+      for (auto point : { next_src, next_src + next.sizes[next_slot] }) {
+        breakpoints.push_back(point);
+        for (size_t slot = 1; slot < src_starts.size(); slot++) {
+          if (point >= dst_starts[slot] &&
+              point < wide { dst_starts[slot] } + sizes[slot]) {
+            breakpoints.push_back(src_starts[slot] +
+                                  (point - dst_starts[slot]));
+          }
+        }
+      }
+    }
+    std::ranges::sort(breakpoints);
+    auto [first, last] = std::ranges::unique(breakpoints);
+    breakpoints.erase(first, last);
+    std::erase_if(breakpoints, [&](auto b) { return b >= domain_end; });
+
+    /* evaluate the composition at the start of every piece, only the pieces
+     * that move their keys are kept and contiguous pieces with the same
+     * offset are merged together (while their size still fits in T)
+     */
+    std::vector<entry> entries;
+    for (size_t k = 0; k < breakpoints.size(); k++) {
+      auto start = static_cast<T>(breakpoints[k]);
+      auto end = k + 1 < breakpoints.size() ? breakpoints[k + 1] : domain_end;
+      auto image = next.search(search(start));
+      if (image == start) {
+        continue;
+      }
+      auto size = static_cast<T>(end - start);
+      if (!entries.empty()) {
+        auto& [prev_start, prev_dst] = entries.back();
+        auto& [prev_image, prev_size] = prev_dst;
+        if (wide { prev_start } + prev_size == start &&
+            wide { prev_image } + prev_size == image &&
+            wide { prev_size } + size < domain_end) {
+          prev_size += size;
+          continue;
+        }
+      }
+      entries.push_back({ start, { image, size } });
+    }
+    return from_entries(std::move(entries));
+  }
+
+  template <std::unsigned_integral T>
+  auto basic_interval_map<T>::lowest_image_of(
+    std::vector<interval> const& targets) const -> std::optional<T> {
+    /* piece = <image, <src, size>>, an entry only covers keys up to the next
+     * source start (past it search resolves with the next slot) and every
+     * key not covered by an entry maps to itself
+     */
+    std::vector<std::pair<wide, std::pair<wide, wide>>> pieces;
+    for (size_t slot = 0; slot < src_starts.size(); slot++) {
+      wide src = src_starts[slot];
+      wide next_start =
+        slot + 1 < src_starts.size() ? src_starts[slot + 1] : domain_end;
+      auto covered_end = std::min(next_start, src + sizes[slot]);
+      if (covered_end > src) {
+        pieces.push_back({ dst_starts[slot], { src, covered_end - src } });
+      }
+      auto gap_start = std::max(covered_end, src);
+      if (next_start > gap_start) {
+        pieces.push_back({ gap_start, { gap_start, next_start - gap_start } });
+      }
+    }
+    std::ranges::sort(pieces, {}, [](auto const& p) { return p.first; });
+
+    // the offset of the first target key in [src, src + size), if any
+    auto first_hit = [&](wide src, wide size) -> std::optional<wide> {
+      auto it = std::ranges::upper_bound(targets, src, {}, &interval::second);
+      if (it == std::end(targets) || it->first >= src + size) {
+        return std::nullopt;
+      }
+      return std::max(src, it->first) - src;
+    };
+
+    std::optional<wide> best;
+    for (auto const& [image, src] : pieces) {
+      if (best && image >= *best) {
+        break;
+      }
+      if (auto offset = first_hit(src.first, src.second)) {
+        best = std::min(best.value_or(image + *offset), image + *offset);
+      }
+    }
+    return best.transform([](wide image) { return static_cast<T>(image); });
+  }
+
+  template class basic_interval_map<std::uint32_t>;
+  template class basic_interval_map<std::uint64_t>;
+  template class basic_almanac<std::uint32_t>;
+  template class basic_almanac<std::uint64_t>;
+
 } // namespace aoc::day5
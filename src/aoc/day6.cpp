@@ -1,74 +1,245 @@
 #include <aoc/day6.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <istream>
-#include <numeric>
+#include <limits>
 #include <ranges>
-#include <regex>
+#include <span>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 namespace aoc::day6 {
-  using std::regex;
-
   struct Races {
-    std::vector<size_t> times;
-    std::vector<size_t> distances;
-    static auto from_str(const std::string&&) -> const Races;
+    std::vector<value> times;
+    std::vector<value> distances;
+    /* join_digits reads each line as a single number, ignoring the spaces
+     * between its digits (the part 2 kerning)
+     */
+    static auto from_str(const std::string&&, bool join_digits = false)
+      -> const Races;
   };
 
-  auto Races::from_str(const std::string&& str) -> const Races {
+  auto to_string(value n) -> std::string {
+    std::string digits;
+    do {
+      digits.push_back(static_cast<char>('0' + n % 10));
+      n /= 10;
+    } while (n != 0);
+    std::ranges::reverse(digits);
+    return digits;
+  }
+
+  auto parse_numbers(std::string_view line, bool join_digits)
+    -> std::vector<value> {
+    constexpr auto max = std::numeric_limits<value>::max();
+
+    std::vector<value> numbers;
+    bool in_number = false;
+    for (auto c : line) {
+      if (std::isdigit(c)) {
+        if (!in_number) {
+          numbers.push_back(0);
+          in_number = true;
+        }
+        auto digit = static_cast<value>(c - '0');
+        if (numbers.back() > (max - digit) / 10) {
+          throw std::overflow_error("race value does not fit in 128 bits");
+        }
+        numbers.back() = numbers.back() * 10 + digit;
+      } else if (!join_digits || c != ' ') {
+        in_number = false;
+      }
+    }
+    return numbers;
+  }
+
+  auto Races::from_str(const std::string&& str, bool join_digits)
+    -> const Races {
     auto stream { std::istringstream { std::string { str } } };
     std::string line;
 
-    std::vector<size_t> times;
-    std::vector<size_t> distances;
-
     std::getline(stream, line, ':');
     std::getline(stream, line);
-    auto time_str = std::istringstream { line };
-    std::ranges::copy(std::views::istream<size_t>(time_str),
-                      std::back_inserter(times));
+    auto times = parse_numbers(line, join_digits);
 
     std::getline(stream, line, ':');
     std::getline(stream, line);
-    auto distance_str = std::istringstream { line };
-    std::ranges::copy(std::views::istream<size_t>(distance_str),
-                      std::back_inserter(distances));
+    auto distances = parse_numbers(line, join_digits);
 
     return { .times = times, .distances = distances };
   };
 
+  auto isqrt(value n) -> value {
+    if (n < 2) {
+      return n;
+    }
+    /* newton from above: start a bit over the long double estimate, then
+     * x = (x + n / x) / 2 decreases until it reaches floor(sqrt(n))
+     */
+    auto estimate = static_cast<value>(std::sqrt(static_cast<long double>(n)));
+    auto root = std::min<value>(estimate + (estimate >> 16) + 2,
+                                std::numeric_limits<std::uint64_t>::max());
+    for (auto next = (root + n / root) / 2; next < root;
+         next = (root + n / root) / 2) {
+      root = next;
+    }
+    return root;
+  }
+
+  /* i * (time - i) grows with i up to time / 2, so the lowest winning hold
+   * is found by bisection, a product that overflows 128 bits is bigger than
+   * any distance and so always wins
+   */
+  auto lowest_win(value time, value distance) -> value {
+    auto wins = [&](value i) {
+      value product;
+      return __builtin_mul_overflow(i, time - i, &product) ||
+        product > distance;
+    };
+    value lo = 0;
+    value hi = time / 2 + 1;
+    while (lo < hi) {
+      auto mid = lo + (hi - lo) / 2;
+      if (wins(mid)) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+
+  /* holding the button for i wins when i * (time - i) > distance, which is
+   * the open interval between the roots of i^2 - time * i + distance, the
+   * wins are symmetric so only the lowest one is needed:
+   *  lo = (time - sqrt(time^2 - 4 * distance)) / 2, fixed up exactly
+   *  count = (time - lo) - lo + 1
+   * when time^2 or 4 * distance do not fit in 128 bits lo is searched for
+   */
+  auto count_wins(value time, value distance) -> value {
+    if (time > std::numeric_limits<std::uint64_t>::max() ||
+        distance > std::numeric_limits<value>::max() / 4) {
+      auto lo = lowest_win(time, distance);
+      return lo <= time / 2 ? time - 2 * lo + 1 : 0;
+    }
+    if (time * time < 4 * distance) {
+      return 0;
+    }
+    auto wins = [&](value i) { return i * (time - i) > distance; };
+
+    auto lo = (time - isqrt(time * time - 4 * distance)) / 2;
+    while (lo <= time / 2 && !wins(lo)) {
+      lo++;
+    }
+    while (lo > 0 && wins(lo - 1)) {
+      lo--;
+    }
+    return lo <= time / 2 && wins(lo) ? time - 2 * lo + 1 : 0;
+  }
+
+  auto count_wins_batch(std::span<const std::uint64_t> times,
+                        std::span<const std::uint64_t> distances,
+                        std::span<std::uint64_t> wins) -> void {
+    /* below 2^26 the discriminant is below 2^52, so it is exact as a double
+     * and its correctly rounded sqrt floors to the exact isqrt, which puts
+     * the first guess of lo at most one away from the real one
+     */
+    constexpr std::uint64_t exact_limit = std::uint64_t { 1 } << 26;
+
+    // split the races first, the rare big ones take the exact path
+    std::vector<size_t> small;
+    std::vector<std::int64_t> small_times;
+    std::vector<std::int64_t> small_distances;
+    for (size_t k = 0; k < times.size(); k++) {
+      if (times[k] < exact_limit &&
+          distances[k] < exact_limit * exact_limit) {
+        small.push_back(k);
+        small_times.push_back(static_cast<std::int64_t>(times[k]));
+        small_distances.push_back(static_cast<std::int64_t>(distances[k]));
+      } else {
+        wins[k] =
+          static_cast<std::uint64_t>(count_wins(times[k], distances[k]));
+      }
+    }
+
+    std::vector<std::uint64_t> small_wins(small.size());
+    for (size_t j = 0; j < small.size(); j++) {
+      auto time = small_times[j];
+      auto distance = small_distances[j];
+      auto disc = time * time - 4 * distance;
+      auto root = static_cast<std::int64_t>(
+        std::sqrt(static_cast<double>(std::max<std::int64_t>(disc, 0))));
+
+      auto lo = (time - root) / 2;
+      auto beats = [&](std::int64_t i) { return i * (time - i) > distance; };
+      lo = lo - beats(lo - 1) + !beats(lo);
+      small_wins[j] = disc >= 0 && lo <= time / 2 && beats(lo)
+        ? static_cast<std::uint64_t>(time - 2 * lo + 1)
+        : 0;
+    }
+
+    for (size_t j = 0; j < small.size(); j++) {
+      wins[small[j]] = small_wins[j];
+    }
+  }
+
+  // multiplies the win counts of the races, the product is checked
+  auto product(std::ranges::input_range auto&& wins) -> value {
+    value result = 1;
+    for (value count : wins) {
+      if (__builtin_mul_overflow(result, count, &result)) {
+        throw std::overflow_error("product of the wins does not fit in 128 "
+                                  "bits");
+      }
+    }
+    return result;
+  }
+
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>, std::function<std::string()>> {
 
     const auto str = std::string { std::istreambuf_iterator<char> { input },
                                    std::istreambuf_iterator<char> {} };
     const auto compute = [](Races problem) {
-      auto records =
-        std::views::zip(problem.times, problem.distances) |
+      constexpr value word_max = std::numeric_limits<std::uint64_t>::max();
+      auto fits = [](value v) { return v <= word_max; };
+      if (std::ranges::all_of(problem.times, fits) &&
+          std::ranges::all_of(problem.distances, fits)) {
+        auto to_words = std::views::transform(
+          [](value v) { return static_cast<std::uint64_t>(v); });
+        auto times = problem.times | to_words |
+          std::ranges::to<std::vector<std::uint64_t>>();
+        auto distances = problem.distances | to_words |
+          std::ranges::to<std::vector<std::uint64_t>>();
+        std::vector<std::uint64_t> wins(times.size());
+        count_wins_batch(times, distances, wins);
+        return product(wins);
+      }
+
+      auto records = std::views::zip(problem.times, problem.distances) |
         std::views::transform([](const auto& pair) {
-          auto records = std::views::iota(0ull, std::get<0>(pair)) |
-            std::views::transform([&](const auto i) {
-                           return i * (std::get<0>(pair) - i);
-                         }) |
-            std::views::filter([&](auto i) { return i > std::get<1>(pair); });
-          return std::ranges::distance(records);
-        });
-      return std::accumulate(std::begin(records), std::end(records), 1ull,
-                             std::multiplies<>());
+                       return count_wins(std::get<0>(pair), std::get<1>(pair));
+                     });
+      return product(records);
     };
 
     const auto pt1 = [=]() -> const std::string {
       const auto problem = Races::from_str(std::move(str));
-      return std::to_string(compute(problem));
+      return to_string(compute(problem));
     };
 
     const auto pt2 = [=]() -> const std::string {
-      auto problem =
-        Races::from_str(std::regex_replace(str, std::regex(" "), ""));
-      return std::to_string(compute(problem));
+      const auto problem = Races::from_str(std::move(str), true);
+      return to_string(compute(problem));
     };
 
     return { pt1, pt2 };
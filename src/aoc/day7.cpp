@@ -1,500 +1,463 @@
 #include <algorithm>
 #include <aoc/day7.hpp>
+#include <aoc/thread_pool.hpp>
 
+#include <array>
+#include <charconv>
 #include <cstdint>
 #include <functional>
 #include <iostream>
 #include <istream>
 #include <iterator>
-#include <map>
 #include <numeric>
 #include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace aoc::day7 {
-  struct CamelCardHand {
-    std::string hand;
-    std::uint32_t bid;
-
-    enum class HandType : std::uint8_t {
-      Unknown,
-      HighCard,
-      OnePair,
-      TwoPair,
-      ThreeOfAKind,
-      FullHouse,
-      FourOfAKind,
-      FiveOfAKind,
-    };
+  // the hand types from the lowest to the highest, the top 4 bits of a key
+  enum class HandType : std::uint8_t {
+    Unknown,
+    HighCard,
+    OnePair,
+    TwoPair,
+    ThreeOfAKind,
+    FullHouse,
+    FourOfAKind,
+    FiveOfAKind,
+  };
 
-    enum class CardType : std::uint8_t {
-      NewJoker,
-      Two,
-      Three,
-      Four,
-      Five,
-      Six,
-      Seven,
-      Eight,
-      Nine,
-      Ten,
-      Joker,
-      Queen,
-      King,
-      Ace,
-    };
+  static constexpr unsigned key_bits = 24;
+
+  /* keyed_hand = <key, bid>
+   * where:
+   *  key is the packed hand
+   *  bid is the bid of the hand
+   */
+  using keyed_hand = std::pair<std::uint32_t, std::uint32_t>;
+
+  // the rank of the cards the rules do not know
+  static constexpr std::uint8_t unknown_card = 0xff;
+
+  // card_ranks = the rank of each card under the rules, 0 for the lowest
+  template <typename Rules>
+  static constexpr auto card_ranks = [] {
+    std::array<std::uint8_t, 256> ranks {};
+    ranks.fill(unknown_card);
+    for (std::uint8_t rank = 0; rank < Rules::card_order.size(); rank++) {
+      ranks[static_cast<unsigned char>(Rules::card_order[rank])] = rank;
+    }
+    return ranks;
+  }();
 
-    static const std::map<char, CardType> char_to_type;
-    static const std::map<HandType, std::string> hand_type_to_string;
-    static const std::map<CardType, char> card_type_to_char;
+  template <typename Rules>
+  constexpr auto card_rank(char c) -> std::uint8_t {
+    return card_ranks<Rules>[static_cast<unsigned char>(c)];
+  }
 
-    static const std::vector<
-      std::pair<CamelCardHand::HandType,
-                const std::function<bool(
-                  std::map<CamelCardHand::CardType, std::uint32_t> const&)>>>
-      patterns;
+  // a hand is exactly 5 cards, all of them known to the rules
+  template <typename Rules>
+  constexpr auto valid_hand(std::string_view hand) -> bool {
+    return hand.size() == 5 && std::ranges::none_of(hand, [](char c) {
+             return card_rank<Rules>(c) == unknown_card;
+           });
+  }
 
-    static const std::vector<
-      std::pair<CamelCardHand::HandType,
-                const std::function<bool(
-                  std::map<CamelCardHand::CardType, std::uint32_t> const&)>>>
-      patterns_joker;
+  /* hand_types[first][second] = the type of a hand whose two largest card
+   * counts are first and second, any other pair of counts cannot be made
+   * out of 5 cards and stays Unknown
+   */
+  static constexpr auto hand_types = [] {
+    using enum HandType;
+    std::array<std::array<HandType, 6>, 6> types {};
+    types[5][0] = FiveOfAKind;
+    types[4][1] = FourOfAKind;
+    types[3][2] = FullHouse;
+    types[3][1] = ThreeOfAKind;
+    types[2][2] = TwoPair;
+    types[2][1] = OnePair;
+    types[1][1] = HighCard;
+    return types;
+  }();
+
+  /* classify the hand by its two largest card counts, the wildcards always
+   * join the largest group as that is the best hand they can make, throws
+   * std::invalid_argument when the hand is not valid
+   */
+  template <typename Rules>
+  constexpr auto classify_groups(std::string_view hand, char wildcard)
+    -> HandType {
+    if (!valid_hand<Rules>(hand)) {
+      throw std::invalid_argument("invalid hand " + std::string(hand));
+    }
+    std::array<std::uint8_t, Rules::card_order.size()> counts {};
+    for (auto c : hand) {
+      counts[card_rank<Rules>(c)]++;
+    }
 
-    friend auto operator>>(std::istream& input, CamelCardHand& handler)
-      -> std::istream&;
+    std::uint8_t wildcards = 0;
+    if (wildcard != '\0') {
+      wildcards = std::exchange(counts[card_rank<Rules>(wildcard)], 0);
+    }
 
-    friend auto operator<<(std::ostream& output, CamelCardHand const& handler)
-      -> std::ostream&;
+    std::uint8_t first = 0;
+    std::uint8_t second = 0;
+    for (auto count : counts) {
+      second = std::max(second, std::min(first, count));
+      first = std::max(first, count);
+    }
+    return hand_types[first + wildcards][second];
+  }
+
+  /* rule sets = how the cards of a hand are ranked and the hand classified
+   * where:
+   *  card_order lists the cards from the lowest to the highest
+   *  classify gives the type of a hand, throwing std::invalid_argument when
+   *  it is not 5 cards of card_order
+   */
+  struct standard_rules {
+    static constexpr std::string_view card_order = "23456789TJQKA";
+
+    static constexpr auto classify(std::string_view hand)
+      -> HandType {
+      return classify_groups<standard_rules>(hand, '\0');
+    }
+  };
 
-    friend auto operator<(CamelCardHand const& lhs, CamelCardHand const& rhs)
-      -> bool;
+  // the jokers join the largest group of the other cards
+  struct joker_rules {
+    static constexpr std::string_view card_order = "J23456789TQKA";
 
-    [[nodiscard]] auto evaluate() const -> HandType;
-    [[nodiscard]] auto evaluate_joker() const -> HandType;
+    static constexpr auto classify(std::string_view hand)
+      -> HandType {
+      return classify_groups<joker_rules>(hand, 'J');
+    }
   };
 
-  auto operator>>(std::istream& input, CamelCardHand::CardType& card_type)
-    -> std::istream& {
-    char c;
-    input >> c;
-    card_type = CamelCardHand::char_to_type.at(c);
-    return input;
+  /* hand_key = the hand packed in 24 bits, 4 bits of hand type followed by 4
+   * bits of card rank for each of the 5 cards, so comparing the keys
+   * compares the hands
+   */
+  template <typename Rules>
+  constexpr auto hand_key(std::string_view hand) -> std::uint32_t {
+    auto key = static_cast<std::uint32_t>(Rules::classify(hand));
+    for (auto c : hand) {
+      key = key << 4 | card_rank<Rules>(c);
+    }
+    return key;
   }
 
-  auto operator<<(std::ostream& output,
-                  CamelCardHand::CardType const& card_type) -> std::ostream& {
-    output << CamelCardHand::card_type_to_char.at(card_type);
-    return output;
+  static_assert(hand_key<standard_rules>("JJJJJ") >
+                hand_key<standard_rules>("AAAAK"));
+  static_assert(hand_key<joker_rules>("JJJJJ") <
+                hand_key<joker_rules>("2222J"));
+  static_assert(hand_key<joker_rules>("QJJQ2") >
+                hand_key<joker_rules>("KKK23"));
+
+  /* lsd radix sort of the hands by key, one pass per byte of the key, each
+   * pass is a counting sort so the whole ranking is linear
+   */
+  auto radix_sort(std::vector<keyed_hand>& hands) -> void {
+    std::vector<keyed_hand> buffer(hands.size());
+    for (unsigned shift = 0; shift < key_bits; shift += 8) {
+      std::array<size_t, 257> offsets {};
+      for (auto const& [key, bid] : hands) {
+        offsets[((key >> shift) & 0xff) + 1]++;
+      }
+      std::partial_sum(std::begin(offsets), std::end(offsets),
+                       std::begin(offsets));
+      for (auto const& hand : hands) {
+        buffer[offsets[(hand.first >> shift) & 0xff]++] = hand;
+      }
+      hands.swap(buffer);
+    }
   }
 
-  auto operator>>(std::istream& input, CamelCardHand& handler)
-    -> std::istream& {
-    return input >> handler.hand >> handler.bid;
-  }
+  /* parallel_radix_sort = the same passes as radix_sort with the hands cut
+   * in a few blocks per worker
+   * where:
+   *  every block counts its own digits, the offsets are then laid out digit
+   *  by digit and block by block, so that each block scatters its hands to
+   *  a disjoint set of slots and the sort stays stable
+   */
+  auto parallel_radix_sort(std::vector<keyed_hand>& hands) -> void {
+    auto& pool = thread_pool::shared();
+    const size_t blocks = 4 * pool.size();
+    const size_t block_size = (hands.size() + blocks - 1) / blocks;
+    std::vector<keyed_hand> buffer(hands.size());
+    std::vector<std::array<size_t, 256>> offsets(blocks);
+
+    auto for_each_block = [&](auto const& body) {
+      pool.parallel_for(blocks, 1, [&](size_t first, size_t last) {
+        for (auto block = first; block < last; block++) {
+          body(block, std::min(hands.size(), block * block_size),
+               std::min(hands.size(), (block + 1) * block_size));
+        }
+      });
+    };
 
-  auto operator<<(std::ostream& output, CamelCardHand const& handler)
-    -> std::ostream& {
-    return output << "[hand] " << handler.hand << " " << handler.bid << " => "
-                  << CamelCardHand::hand_type_to_string.at(
-                       handler.evaluate_joker());
-  }
+    for (unsigned shift = 0; shift < key_bits; shift += 8) {
+      for_each_block([&](size_t block, size_t begin, size_t end) {
+        auto& counts = offsets[block];
+        counts.fill(0);
+        for (auto i = begin; i < end; i++) {
+          counts[(hands[i].first >> shift) & 0xff]++;
+        }
+      });
+
+      size_t offset = 0;
+      for (size_t digit = 0; digit < 256; digit++) {
+        for (auto& counts : offsets) {
+          offset += std::exchange(counts[digit], offset);
+        }
+      }
 
-  auto operator<(CamelCardHand const& lhs, CamelCardHand const& rhs) -> bool {
-    auto lhs_type = lhs.evaluate();
-    auto rhs_type = rhs.evaluate();
+      for_each_block([&](size_t block, size_t begin, size_t end) {
+        auto& next = offsets[block];
+        for (auto i = begin; i < end; i++) {
+          buffer[next[(hands[i].first >> shift) & 0xff]++] = hands[i];
+        }
+      });
+      hands.swap(buffer);
+    }
+  }
 
-    if (lhs_type != rhs_type)
-      return lhs_type < rhs_type;
+  /* hand sets at least this large are ranked on the shared thread pool,
+   * inputs at least parallel_threshold * 8 bytes long are parsed on it
+   */
+  constexpr size_t parallel_threshold = 1 << 16;
 
-    for (const auto& [lhs_card, rhs_card] :
-         std::views::zip(lhs.hand, rhs.hand)) {
-      auto lhs_card_type = CamelCardHand::char_to_type.at(lhs_card);
-      auto rhs_card_type = CamelCardHand::char_to_type.at(rhs_card);
+  // sum of bid * rank, the ranks being the positions in the sorted hands
+  auto total_winnings(std::vector<keyed_hand> hands) -> std::uint64_t {
+    if (hands.size() < parallel_threshold) {
+      radix_sort(hands);
+      auto indexes = std::views::iota(std::uint64_t { 1 }, hands.size() + 1);
+      auto hand_index_pairs = std::views::zip(hands, indexes);
 
-      if (lhs_card_type != rhs_card_type)
-        return lhs_card_type < rhs_card_type;
+      return std::accumulate(std::begin(hand_index_pairs),
+                             std::end(hand_index_pairs), std::uint64_t { 0 },
+                             [](std::uint64_t acc, auto const& hand_index) {
+                               auto const& [hand, index] = hand_index;
+                               return acc + hand.second * index;
+                             });
     }
 
-    return false;
+    parallel_radix_sort(hands);
+
+    // one sum per worker, padded so that they do not share a cache line
+    struct alignas(64) padded_sum {
+      std::uint64_t value = 0;
+    };
+
+    auto& pool = thread_pool::shared();
+    std::vector<padded_sum> sums(pool.size() + 1);
+    pool.parallel_for(hands.size(), parallel_threshold / 4,
+                      [&](size_t begin, size_t end) {
+                        auto& sum = sums[pool.worker_index()].value;
+                        for (auto i = begin; i < end; i++) {
+                          sum += hands[i].second * std::uint64_t { i + 1 };
+                        }
+                      });
+
+    return std::accumulate(std::begin(sums), std::end(sums),
+                           std::uint64_t { 0 },
+                           [](std::uint64_t acc, padded_sum const& sum) {
+                             return acc + sum.value;
+                           });
   }
 
-  auto CamelCardHand::evaluate() const -> HandType {
-    auto hand_histogram =
-      hand | std::views::transform([this](auto const& c) {
-        auto card_type = char_to_type.at(c);
-        auto count = static_cast<std::uint32_t>(std::ranges::count(hand, c));
-        return std::pair { card_type, count };
-      }) |
-      std::ranges::to<std::map<CardType, std::uint32_t>>();
+  /* keyed hands of the "<hand> <bid>" lines of text, blank lines are
+   * skipped and any other line that is not a valid hand followed by a bid
+   * throws std::invalid_argument
+   */
+  template <typename Rules>
+  auto parse_keyed(std::string_view text) -> std::vector<keyed_hand> {
+    std::vector<keyed_hand> hands;
+    while (!text.empty()) {
+      auto line = text.substr(0, text.find('\n'));
+      text.remove_prefix(std::min(text.size(), line.size() + 1));
+      line = line.substr(0, line.find_last_not_of(" \r") + 1);
+      if (line.empty()) {
+        continue;
+      }
 
-    auto [hand_type, _] = *std::ranges::find_if(
-      patterns,
-      [&](auto const& pattern) { return pattern.second(hand_histogram); });
+      auto invalid = [&]() {
+        return std::invalid_argument("invalid line " + std::string(line));
+      };
+      auto space = line.find(' ');
+      if (space == std::string_view::npos) {
+        throw invalid();
+      }
+      // line has no trailing space, so there is a bid after the spaces
+      auto bid_text = line.substr(line.find_first_not_of(' ', space));
+      auto bid_end = bid_text.data() + bid_text.size();
+      std::uint32_t bid = 0;
+      auto [end, error] = std::from_chars(bid_text.data(), bid_end, bid);
+      auto hand = line.substr(0, space);
+      if (error != std::errc {} || end != bid_end || !valid_hand<Rules>(hand)) {
+        throw invalid();
+      }
+      hands.emplace_back(hand_key<Rules>(hand), bid);
+    }
+    return hands;
+  }
+
+  /* parse_keyed over a few blocks of lines per worker, the block bounds are
+   * moved forward to the next line start and the blocks are joined in order
+   */
+  template <typename Rules>
+  auto parallel_parse_keyed(std::string_view text) -> std::vector<keyed_hand> {
+    auto& pool = thread_pool::shared();
+    const size_t blocks = 4 * pool.size();
+
+    auto line_start = [&](size_t block) -> size_t {
+      if (block == 0) {
+        return 0;
+      }
+      if (block == blocks) {
+        return text.size();
+      }
+      auto eol = text.find('\n', text.size() / blocks * block - 1);
+      return eol == std::string_view::npos ? text.size() : eol + 1;
+    };
+
+    std::vector<std::vector<keyed_hand>> parsed(blocks);
+    pool.parallel_for(blocks, 1, [&](size_t first, size_t last) {
+      for (auto block = first; block < last; block++) {
+        auto begin = line_start(block);
+        auto end = std::max(begin, line_start(block + 1));
+        parsed[block] = parse_keyed<Rules>(text.substr(begin, end - begin));
+      }
+    });
+
+    std::vector<keyed_hand> hands;
+    hands.reserve(std::accumulate(
+      std::begin(parsed), std::end(parsed), size_t { 0 },
+      [](size_t acc, auto const& block) { return acc + block.size(); }));
+    for (auto const& block : parsed) {
+      hands.insert(std::end(hands), std::begin(block), std::end(block));
+    }
+    return hands;
+  }
+
+  template <typename Rules>
+  auto total_winnings(std::istream& input) -> std::uint64_t {
+    const std::string text { std::istreambuf_iterator<char>(input),
+                             std::istreambuf_iterator<char>() };
+    return total_winnings(text.size() < 8 * parallel_threshold
+                            ? parse_keyed<Rules>(text)
+                            : parallel_parse_keyed<Rules>(text));
+  }
 
-    return hand_type;
+  // one slot per hand type and sequence of 5 cards
+  static constexpr std::uint32_t leaderboard_slots = 7 * 13 * 13 * 13 * 13 * 13;
+
+  // the slot is the hand type followed by the 5 card ranks in base 13
+  template <typename Rules>
+  constexpr auto hand_slot(std::string_view hand) -> std::uint32_t {
+    auto key = hand_key<Rules>(hand);
+    std::uint32_t slot = (key >> 20) -
+      static_cast<std::uint32_t>(HandType::HighCard);
+    for (int shift = 16; shift >= 0; shift -= 4) {
+      slot = slot * 13 + ((key >> shift) & 0xf);
+    }
+    return slot;
   }
-  auto CamelCardHand::evaluate_joker() const -> HandType {
-    auto hand_histogram =
-      hand | std::views::transform([this](auto const& c) {
-        auto card_type = char_to_type.at(c);
-        auto count = static_cast<std::uint32_t>(std::ranges::count(hand, c));
-        return std::pair { card_type, count };
-      }) |
-      std::ranges::to<std::map<CardType, std::uint32_t>>();
-    auto [hand_type, _] = *std::ranges::find_if(
-      patterns_joker,
-      [&](auto const& pattern) { return pattern.second(hand_histogram); });
-
-    return hand_type;
+
+  template <typename Rules>
+  auto basic_leaderboard<Rules>::slot_of(std::string_view hand) const
+    -> std::uint32_t {
+    if (!valid_hand<Rules>(hand)) {
+      throw std::invalid_argument("invalid hand " + std::string(hand));
+    }
+    return hand_slot<Rules>(hand);
   }
 
-  auto cmp_joker(CamelCardHand const& lhs, CamelCardHand const& rhs) -> bool {
-    auto lhs_type = lhs.evaluate_joker();
-    auto rhs_type = rhs.evaluate_joker();
-
-    if (lhs_type != rhs_type)
-      return lhs_type < rhs_type;
-
-    for (const auto& [lhs_card, rhs_card] :
-         std::views::zip(lhs.hand, rhs.hand)) {
-      auto lhs_card_type = CamelCardHand::char_to_type.at(lhs_card);
-      auto rhs_card_type = CamelCardHand::char_to_type.at(rhs_card);
-
-      if (lhs_card_type != rhs_card_type) {
-        lhs_card_type = lhs_card_type == CamelCardHand::CardType::Joker
-          ? CamelCardHand::CardType::NewJoker
-          : lhs_card_type;
-        rhs_card_type = rhs_card_type == CamelCardHand::CardType::Joker
-          ? CamelCardHand::CardType::NewJoker
-          : rhs_card_type;
-        return lhs_card_type < rhs_card_type;
+  template <typename Rules>
+  auto basic_leaderboard<Rules>::update(std::uint32_t slot, std::uint32_t bid,
+                                        bool add) -> void {
+    for (auto index = slot + 1; index <= leaderboard_slots;
+         index += index & -index) {
+      if (add) {
+        auto& [count, bid_sum] = tree[index];
+        count++;
+        bid_sum += bid;
+      } else if (auto it = tree.find(index); --it->second.count == 0) {
+        // the last hand below this node is gone, so is its bid sum
+        tree.erase(it);
+      } else {
+        it->second.bid_sum -= bid;
       }
     }
+  }
 
-    return false;
+  /* the hand ranks one above the hands in the slots before its own and every
+   * hand after it moves one rank up, which adds their bids once more
+   */
+  template <typename Rules>
+  auto basic_leaderboard<Rules>::winnings(std::uint32_t slot,
+                                          std::uint32_t bid) const
+    -> std::uint64_t {
+    std::uint64_t below = 0;
+    std::uint64_t below_bids = 0;
+    for (auto index = slot; index > 0; index -= index & -index) {
+      if (auto it = tree.find(index); it != std::end(tree)) {
+        below += it->second.count;
+        below_bids += it->second.bid_sum;
+      }
+    }
+    return bid * (below + 1) + (bid_total - below_bids);
   }
 
-  const std::vector<
-    std::pair<CamelCardHand::HandType,
-              const std::function<bool(
-                std::map<CamelCardHand::CardType, std::uint32_t> const&)>>>
-    CamelCardHand::patterns = {
-      { CamelCardHand::HandType::FiveOfAKind,
-        [](auto const& hand) -> bool {
-          return std::ranges::any_of(
-            hand, [](auto const& card) -> bool { return card.second == 5; });
-        } },
-      { CamelCardHand::HandType::FourOfAKind,
-        [](auto const& hand) -> bool {
-          return std::ranges::any_of(
-            hand, [](auto const& card) -> bool { return card.second == 4; });
-        } },
-      { CamelCardHand::HandType::FullHouse,
-        [](auto const& hand) -> bool {
-          return std::ranges::any_of(
-                   hand,
-                   [](auto const& card) -> bool { return card.second == 3; }) &&
-            std::ranges::any_of(hand, [](auto const& card) -> bool {
-                   return card.second == 2;
-                 });
-        } },
-      { CamelCardHand::HandType::ThreeOfAKind,
-        [](auto const& hand) -> bool {
-          return std::ranges::any_of(
-            hand, [](auto const& card) -> bool { return card.second == 3; });
-        } },
-      { CamelCardHand::HandType::TwoPair,
-        [](auto const& hand) -> bool {
-          return std::ranges::count_if(hand, [](auto const& card) -> bool {
-                   return card.second == 2;
-                 }) == 2;
-        } },
-      { CamelCardHand::HandType::OnePair,
-        [](auto const& hand) -> bool {
-          return std::ranges::any_of(
-            hand, [](auto const& card) -> bool { return card.second == 2; });
-        } },
-      { CamelCardHand::HandType::HighCard,
-        [](auto const& hand) -> bool {
-          return std::ranges::all_of(
-            hand, [](auto const& card) -> bool { return card.second == 1; });
-        } }
-    };
+  template <typename Rules>
+  auto basic_leaderboard<Rules>::insert(std::string_view hand,
+                                        std::uint32_t bid) -> void {
+    auto slot = slot_of(hand);
+    if (auto it = bids.find(slot); it != std::end(bids)) {
+      update(slot, it->second, false);
+      bid_total -= it->second;
+      total -= winnings(slot, it->second);
+    }
 
-  const std::vector<
-    std::pair<CamelCardHand::HandType,
-              const std::function<bool(
-                std::map<CamelCardHand::CardType, std::uint32_t> const&)>>>
-    CamelCardHand::patterns_joker = {
-      { CamelCardHand::HandType::FiveOfAKind,
-        [](auto const& hand) -> bool {
-          auto hand_vec = hand |
-            std::ranges::to<std::vector<std::pair<CardType, std::uint32_t>>>();
-          std::sort(std::begin(hand_vec), std::end(hand_vec),
-                    [](auto const& lhs, auto const& rhs) -> bool {
-                      // joker is always higher than any other card
-                      if (lhs.first == CardType::Joker) {
-                        return true;
-                      }
-                      if (rhs.first == CardType::Joker) {
-                        return false;
-                      }
-                      return lhs.second > rhs.second;
-                    });
-
-          // if the first pair has 5 then we have a 5 of a kind
-          if (hand_vec[0].second == 5)
-            return true;
-
-          // if the first pair has 4 and the second has 1 Joker then we have a 5
-          // of a kind
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 1 &&
-              hand_vec[1].second == 4)
-            return true;
-
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 2 &&
-              hand_vec[1].second == 3)
-            return true;
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 3 &&
-              hand_vec[1].second == 2)
-            return true;
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 4 &&
-              hand_vec[1].second == 1)
-            return true;
-
-          return false;
-        } },
-      { CamelCardHand::HandType::FourOfAKind,
-        [](auto const& hand) -> bool {
-          auto hand_vec = hand |
-            std::ranges::to<std::vector<std::pair<CardType, std::uint32_t>>>();
-          std::sort(std::begin(hand_vec), std::end(hand_vec),
-                    [](auto const& lhs, auto const& rhs) -> bool {
-                      // joker is always higher than any other card
-                      if (lhs.first == CardType::Joker) {
-                        return true;
-                      }
-                      if (rhs.first == CardType::Joker) {
-                        return false;
-                      }
-                      return lhs.second > rhs.second;
-                    });
-
-          // if the first pair has 4 then we have a 4 of a kind
-          if (hand_vec[0].second == 4)
-            return true;
-
-          // if the first pair has 3 and the second has 1 Joker then
-          // we have a 4
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 1 &&
-              hand_vec[1].second == 3)
-            return true;
-
-          // if the first pair has 2 and the second has 2 Joker then
-          // we have a 4
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 2 &&
-              hand_vec[1].second == 2)
-            return true;
-
-          // if the first pair has 1 and the second has 3 Joker then
-          // we have a 4
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 3 &&
-              hand_vec[1].second == 1)
-            return true;
-
-          return false;
-        } },
-      { CamelCardHand::HandType::FullHouse,
-        [](auto const& hand) -> bool {
-          auto hand_vec = hand |
-            std::ranges::to<std::vector<std::pair<CardType, std::uint32_t>>>();
-          std::sort(std::begin(hand_vec), std::end(hand_vec),
-                    [](auto const& lhs, auto const& rhs) -> bool {
-                      // joker is always higher than any other card
-                      if (lhs.first == CardType::Joker) {
-                        return true;
-                      }
-                      if (rhs.first == CardType::Joker) {
-                        return false;
-                      }
-                      return lhs.second > rhs.second;
-                    });
-
-          // if the first pair has 3 and the second has 2 then we have a full
-          if (hand_vec[0].second == 3 && hand_vec[1].second == 2)
-            return true;
-
-          // if the first pair has 3 and the second has 1 Joker then we have a
-          // full
-          if ((hand_vec[0].first == CardType::Joker &&
-               hand_vec[0].second == 1 &&
-               (hand_vec[1].second == 2 && hand_vec[2].second == 2)))
-            return true;
-
-          return false;
-        } },
-      { CamelCardHand::HandType::ThreeOfAKind,
-        [](auto const& hand) -> bool {
-          auto hand_vec = hand |
-            std::ranges::to<std::vector<std::pair<CardType, std::uint32_t>>>();
-          std::sort(std::begin(hand_vec), std::end(hand_vec),
-                    [](auto const& lhs, auto const& rhs) -> bool {
-                      // joker is always higher than any other card
-                      if (lhs.first == CardType::Joker) {
-                        return true;
-                      }
-                      if (rhs.first == CardType::Joker) {
-                        return false;
-                      }
-                      return lhs.second > rhs.second;
-                    });
-
-          if (hand_vec[0].second == 3)
-            return true;
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 1 &&
-              hand_vec[1].second == 2)
-            return true;
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 2 &&
-              hand_vec[1].second == 1)
-            return true;
-
-          return false;
-        } },
-      { CamelCardHand::HandType::TwoPair,
-        [](auto const& hand) -> bool {
-          auto hand_vec = hand |
-            std::ranges::to<std::vector<std::pair<CardType, std::uint32_t>>>();
-          std::sort(std::begin(hand_vec), std::end(hand_vec),
-                    [](auto const& lhs, auto const& rhs) -> bool {
-                      if (lhs.first == CardType::Joker) {
-                        return true;
-                      }
-                      if (rhs.first == CardType::Joker) {
-                        return false;
-                      }
-                      return lhs.second > rhs.second;
-                    });
-          if (hand_vec[0].second == 2 && hand_vec[1].second == 2)
-            return true;
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 1 &&
-              hand_vec[1].second == 2 && hand_vec[2].second == 2)
-            return true;
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 2 &&
-              hand_vec[1].second == 1 && hand_vec[2].second == 2)
-            return true;
-
-          return false;
-        } },
-      { CamelCardHand::HandType::OnePair,
-        [](auto const& hand) -> bool {
-          auto hand_vec = hand |
-            std::ranges::to<std::vector<std::pair<CardType, std::uint32_t>>>();
-          std::sort(std::begin(hand_vec), std::end(hand_vec),
-                    [](auto const& lhs, auto const& rhs) -> bool {
-                      if (lhs.first == CardType::Joker) {
-                        return true;
-                      }
-                      if (rhs.first == CardType::Joker) {
-                        return false;
-                      }
-                      return lhs.second > rhs.second;
-                    });
-          if (hand_vec[0].second == 2)
-            return true;
-          if (hand_vec[0].first == CardType::Joker && hand_vec[0].second == 1 &&
-              hand_vec[1].second == 1)
-            return true;
-          return false;
-        } },
-      { CamelCardHand::HandType::HighCard,
-        [](auto const& hand) -> bool {
-          return std::ranges::all_of(
-            hand, [](auto const& card) -> bool { return card.second == 1; });
-        } }
-    };
+    total += winnings(slot, bid);
+    update(slot, bid, true);
+    bid_total += bid;
+    bids[slot] = bid;
+  }
 
-  const std::map<char, CamelCardHand::CardType> CamelCardHand::char_to_type = {
-    { 'A', CamelCardHand::CardType::Ace },
-    { 'K', CamelCardHand::CardType::King },
-    { 'Q', CamelCardHand::CardType::Queen },
-    { 'J', CamelCardHand::CardType::Joker },
-    { 'T', CamelCardHand::CardType::Ten },
-    { '9', CamelCardHand::CardType::Nine },
-    { '8', CamelCardHand::CardType::Eight },
-    { '7', CamelCardHand::CardType::Seven },
-    { '6', CamelCardHand::CardType::Six },
-    { '5', CamelCardHand::CardType::Five },
-    { '4', CamelCardHand::CardType::Four },
-    { '3', CamelCardHand::CardType::Three },
-    { '2', CamelCardHand::CardType::Two }
-  };
+  template <typename Rules>
+  auto basic_leaderboard<Rules>::erase(std::string_view hand) -> bool {
+    auto it = bids.find(slot_of(hand));
+    if (it == std::end(bids)) {
+      return false;
+    }
 
-  const std::map<CamelCardHand::HandType, std::string>
-    CamelCardHand::hand_type_to_string = {
-      { CamelCardHand::HandType::HighCard, "High Card" },
-      { CamelCardHand::HandType::OnePair, "One Pair" },
-      { CamelCardHand::HandType::TwoPair, "Two Pair" },
-      { CamelCardHand::HandType::ThreeOfAKind, "Three of a Kind" },
-      { CamelCardHand::HandType::FullHouse, "Full House" },
-      { CamelCardHand::HandType::FourOfAKind, "Four of a Kind" },
-      { CamelCardHand::HandType::FiveOfAKind, "Five of a Kind" }
-    };
+    auto [slot, bid] = *it;
+    update(slot, bid, false);
+    bid_total -= bid;
+    total -= winnings(slot, bid);
+    bids.erase(it);
+    return true;
+  }
 
-  const std::map<CamelCardHand::CardType, char>
-    CamelCardHand::card_type_to_char = {
-      { CamelCardHand::CardType::Ace, 'A' },
-      { CamelCardHand::CardType::King, 'K' },
-      { CamelCardHand::CardType::Queen, 'Q' },
-      { CamelCardHand::CardType::Joker, 'J' },
-      { CamelCardHand::CardType::Ten, 'T' },
-      { CamelCardHand::CardType::Nine, '9' },
-      { CamelCardHand::CardType::Eight, '8' },
-      { CamelCardHand::CardType::Seven, '7' },
-      { CamelCardHand::CardType::Six, '6' },
-      { CamelCardHand::CardType::Five, '5' },
-      { CamelCardHand::CardType::Four, '4' },
-      { CamelCardHand::CardType::Three, '3' },
-      { CamelCardHand::CardType::Two, '2' }
-    };
+  template class basic_leaderboard<standard_rules>;
+  template class basic_leaderboard<joker_rules>;
 
   auto solution(std::istream& input)
     -> std::pair<std::function<std::string()>,
                  std::function<std::string()>> const {
 
     const auto pt1 = [&]() -> std::string {
-      auto hands = std::views::istream<CamelCardHand>(input) |
-        std::ranges::to<std::vector<CamelCardHand>>();
-      std::sort(std::begin(hands), std::end(hands));
-      auto indexes = std::views::iota(1U, hands.size() + 1);
-      auto hand_index_pairs = std::views::zip(hands, indexes);
-
-      auto sum = std::accumulate(std::begin(hand_index_pairs),
-                                 std::end(hand_index_pairs), 0,
-                                 [](int acc, auto const& hand_index) {
-                                   auto const& [hand, index] = hand_index;
-                                   return acc + hand.bid * index;
-                                 });
-
-      return std::to_string(sum);
+      return std::to_string(total_winnings<standard_rules>(input));
     };
 
     const auto pt2 = [&]() -> std::string {
-      auto hands = std::views::istream<CamelCardHand>(input) |
-        std::ranges::to<std::vector<CamelCardHand>>();
-      std::sort(std::begin(hands), std::end(hands), cmp_joker);
-      auto indexes = std::views::iota(1U, hands.size() + 1);
-      auto hand_index_pairs = std::views::zip(hands, indexes);
-
-      auto sum = std::accumulate(std::begin(hand_index_pairs),
-                                 std::end(hand_index_pairs), 0,
-                                 [](int acc, auto const& hand_index) {
-                                   auto const& [hand, index] = hand_index;
-                                   return acc + hand.bid * index;
-                                 });
-
-      return std::to_string(sum);
+      return std::to_string(total_winnings<joker_rules>(input));
     };
 
     return { pt1, pt2 };
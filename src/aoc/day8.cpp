@@ -1,85 +1,665 @@
 #include <algorithm>
 #include <aoc/day8.hpp>
 
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <numeric>
 #include <print>
 #include <ranges>
 #include <regex>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace aoc::day8 {
+  auto encode_name(std::string_view name) -> std::uint16_t {
+    auto digit = [&](char c) -> std::uint16_t {
+      if (c >= '0' && c <= '9') {
+        return c - '0';
+      }
+      if (c >= 'A' && c <= 'Z') {
+        return c - 'A' + 10;
+      }
+      throw std::invalid_argument("invalid node name " + std::string(name));
+    };
+
+    if (name.size() != 3) {
+      throw std::invalid_argument("invalid node name " + std::string(name));
+    }
+    return (digit(name[0]) * 36 + digit(name[1])) * 36 + digit(name[2]);
+  }
+
+  auto decode_name(std::uint16_t code) -> std::string {
+    constexpr std::string_view digits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    return { digits[code / (36 * 36)], digits[code / 36 % 36],
+             digits[code % 36] };
+  }
+
+  /* the ids are handed out through a flat table indexed by name code, the
+   * links are filled once every name has its id
+   */
   auto graph::from_entries(std::ranges::range auto&& entries) -> graph {
-    auto nodes_map = std::accumulate(
-      std::ranges::begin(entries), std::ranges::end(entries),
-      std::map<std::string, std::pair<std::string, std::string>> {},
-      [](auto&& acc, graph::entry const& entry) {
-        auto const& [name, children] = entry;
-        acc[name] = children;
-        return std::move(acc);
-      });
+    constexpr auto no_node = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> ids(name_codes, no_node);
+    std::vector<std::uint16_t> names;
 
-    return { .nodes = std::move(nodes_map) };
+    auto intern = [&](std::string const& name) {
+      auto code = encode_name(name);
+      if (ids[code] == no_node) {
+        ids[code] = static_cast<std::uint32_t>(names.size());
+        names.push_back(code);
+      }
+      return ids[code];
+    };
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> children;
+    std::vector<bool> defined;
+    for (graph::entry const& entry : entries) {
+      auto const& [name, next] = entry;
+      auto node = intern(name);
+      auto left = intern(next.first);
+      auto right = intern(next.second);
+      children.resize(names.size());
+      defined.resize(names.size());
+      children[node] = { left, right };
+      defined[node] = true;
+    }
+
+    if (auto undefined = std::ranges::find(defined, false);
+        undefined != std::end(defined)) {
+      throw std::invalid_argument(
+        "undefined node " +
+        decode_name(names[std::distance(std::begin(defined), undefined)]));
+    }
+
+    std::vector<std::uint32_t> links(2 * names.size());
+    for (std::size_t node = 0; node < names.size(); node++) {
+      links[node] = children[node].first;
+      links[names.size() + node] = children[node].second;
+    }
+
+    auto arrays = std::make_shared<
+      std::pair<std::vector<std::uint16_t>, std::vector<std::uint32_t>>>(
+      std::move(names), std::move(links));
+    return { .names = arrays->first,
+             .links = arrays->second,
+             .storage = std::move(arrays) };
   }
 
+  auto graph::matching(std::regex const& pattern) const -> node_set {
+    node_set nodes(size());
+    for (std::uint32_t node = 0; node < size(); node++) {
+      if (std::regex_match(decode_name(names[node]), pattern)) {
+        nodes.insert(node);
+      }
+    }
+    return nodes;
+  }
+
+  namespace {
+    /* simulate_kernels = one step of the lock step walks
+     * where:
+     *  all_ends tells whether every walk stands on a node of the bitset
+     *  advance moves every walk to its successor in side
+     *  the walks come in whole vectors of graph::lanes
+     */
+    struct simulate_kernels {
+      bool (*all_ends)(std::uint64_t const* words,
+                       std::span<std::uint32_t const> walks);
+      void (*advance)(std::uint32_t const* side,
+                      std::span<std::uint32_t> walks);
+    };
+
+    auto all_ends(std::uint64_t const* words,
+                  std::span<std::uint32_t const> walks) -> bool {
+      std::uint64_t misses = 0;
+      for (auto node : walks) {
+        misses |= ~(words[node / 64] >> (node % 64)) & 1;
+      }
+      return misses == 0;
+    }
+
+    auto advance(std::uint32_t const* side, std::span<std::uint32_t> walks)
+      -> void {
+      for (auto& node : walks) {
+        node = side[node];
+      }
+    }
+
+#if defined(__x86_64__)
+    /* the bitset is read as 32 bit words (little endian), the word of a node
+     * is gathered at node / 32 and its bit shifted down by node % 32. node
+     * ids are below name_codes, so they are valid signed gather indexes
+     */
+    __attribute__((target("avx2"))) auto all_ends_avx2(
+      std::uint64_t const* words, std::span<std::uint32_t const> walks)
+      -> bool {
+      const auto* bits = reinterpret_cast<int const*>(words);
+      const auto one = _mm256_set1_epi32(1);
+      const auto bit_mask = _mm256_set1_epi32(31);
+      auto misses = _mm256_setzero_si256();
+      for (std::size_t base = 0; base < walks.size(); base += graph::lanes) {
+        auto nodes = _mm256_loadu_si256(
+          reinterpret_cast<__m256i const*>(walks.data() + base));
+        auto word_index = _mm256_srli_epi32(nodes, 5);
+        auto word = _mm256_i32gather_epi32(bits, word_index, 4);
+        auto bit = _mm256_srlv_epi32(word, _mm256_and_si256(nodes, bit_mask));
+        misses = _mm256_or_si256(misses, _mm256_andnot_si256(bit, one));
+      }
+      return _mm256_testz_si256(misses, misses) != 0;
+    }
+
+    __attribute__((target("avx2"))) auto advance_avx2(
+      std::uint32_t const* side, std::span<std::uint32_t> walks) -> void {
+      const auto* links = reinterpret_cast<int const*>(side);
+      for (std::size_t base = 0; base < walks.size(); base += graph::lanes) {
+        auto* lane = reinterpret_cast<__m256i*>(walks.data() + base);
+        _mm256_storeu_si256(
+          lane, _mm256_i32gather_epi32(links, _mm256_loadu_si256(lane), 4));
+      }
+    }
+#endif
+
+    auto pick_simulate_kernels() -> simulate_kernels {
+#if defined(__x86_64__)
+      if (__builtin_cpu_supports("avx2")) {
+        return { all_ends_avx2, advance_avx2 };
+      }
+#endif
+      return { all_ends, advance };
+    }
+  } // namespace
+
+  /* the walks are padded to whole vectors with copies of the first one, each
+   * step then tests every walk against the end bitset and moves it along
+   * the link array of the instruction, both with the kernels of the cpu
+   */
+  auto graph::simulate(std::span<instruction const> instructions,
+                       std::span<std::uint32_t const> starts,
+                       node_set const& ends, std::uint64_t max_steps) const
+    -> std::optional<std::uint64_t> {
+    if (starts.empty()) {
+      return 0;
+    }
+    if (instructions.empty()) {
+      throw std::invalid_argument("no instructions");
+    }
+
+    static const auto kernels = pick_simulate_kernels();
+    std::vector<std::uint32_t> current((starts.size() + lanes - 1) / lanes *
+                                         lanes,
+                                       starts.front());
+    std::ranges::copy(starts, std::begin(current));
+
+    std::size_t index = 0;
+    for (std::uint64_t step = 0;; step++) {
+      if (kernels.all_ends(ends.words.data(), current)) {
+        return step;
+      }
+      if (step == max_steps) {
+        return std::nullopt;
+      }
+
+      const auto* side = links.data() +
+        (instructions[index] == instruction::right ? size() : 0);
+      kernels.advance(side, current);
+      index = index + 1 == instructions.size() ? 0 : index + 1;
+    }
+  }
+
+  /* walks meeting within a few thousand steps are simulated, the longer
+   * ones are solved on their cycles, the budget stays a small fraction of
+   * building the pass table so that it barely adds to the real inputs
+   */
   auto graph::traverse(std::ranges::range auto&& instructions, std::regex begin,
                        std::regex end) const -> std::uint64_t {
-    auto steps_from_to = [&](auto from, auto to) {
-      std::uint64_t steps = 0;
-      while (!std::regex_match(from, to)) {
-        switch (instructions[steps++ % instructions.size()]) {
-        case instruction::left:
-          from = std::get<0>(nodes.at(from));
-          break;
-        case instruction::right:
-          from = std::get<1>(nodes.at(from));
-          break;
+    const std::span<instruction const> steps_of_pass {
+      std::ranges::data(instructions), std::ranges::size(instructions)
+    };
+    const auto ends = matching(end);
+    const auto starts = matching(begin);
+    const auto start_nodes =
+      std::views::iota(std::uint32_t { 0 }, size()) |
+      std::views::filter(
+        [&](std::uint32_t node) { return starts.contains(node); }) |
+      std::ranges::to<std::vector<std::uint32_t>>();
+
+    if (auto steps =
+          simulate(steps_of_pass, start_nodes, ends, simulated_steps)) {
+      return *steps;
+    }
+
+    const auto passes = pass_table::from_graph(*this, steps_of_pass, ends);
+    auto walks = start_nodes |
+      std::views::transform(
+                   [&](std::uint32_t node) { return passes.cycle_of(node); }) |
+      std::ranges::to<std::vector<walk_cycle>>();
+
+    auto steps = first_meeting(walks);
+    if (!steps) {
+      throw std::runtime_error("the walks never all stand on end nodes");
+    }
+    return *steps;
+  }
+
+  /* the first level walks every node through one pass, each further level
+   * is the previous one applied twice
+   */
+  auto pass_table::from_graph(graph const& g,
+                              std::span<instruction const> instructions,
+                              node_set const& ends) -> pass_table {
+    if (instructions.empty() ||
+        instructions.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::invalid_argument("instructions must have 1 to 2^32 - 1 steps");
+    }
+
+    pass_table table { .period = instructions.size(), .nodes = g.size() };
+    table.levels = 65 - std::bit_width(table.period);
+    table.hit_starts.reserve(table.nodes + 1);
+    table.jumps.resize(std::size_t { table.levels } * table.nodes);
+    table.hits.resize(std::size_t { table.levels } * table.nodes);
+
+    for (std::uint32_t start = 0; start < table.nodes; start++) {
+      auto node = start;
+      table.hit_starts.push_back(table.hit_offsets.size());
+      for (std::uint32_t offset = 0; offset < table.period; offset++) {
+        if (ends.contains(node)) {
+          table.hit_offsets.push_back(offset);
         }
+        node = g.next(node, instructions[offset]);
       }
+      table.jumps[start] = node;
+      table.hits[start] = table.hit_offsets.size() > table.hit_starts.back();
+    }
+    table.hit_starts.push_back(table.hit_offsets.size());
 
-      return steps;
-    };
+    for (std::size_t level = 1; level < table.levels; level++) {
+      auto prev = (level - 1) * table.nodes;
+      auto cur = level * table.nodes;
+      for (std::uint32_t node = 0; node < table.nodes; node++) {
+        auto half = table.jumps[prev + node];
+        table.jumps[cur + node] = table.jumps[prev + half];
+        table.hits[cur + node] =
+          table.hits[prev + node] || table.hits[prev + half];
+      }
+    }
+    return table;
+  }
 
-    auto steps = nodes | std::views::keys | std::views::filter([&](auto node) {
-                   return std::regex_match(node, begin);
-                 }) |
-      std::views::transform(
-                   [&](auto node) { return steps_from_to(node, end); }) |
-      std::ranges::to<std::vector<int>>();
+  auto pass_table::after_passes(std::uint32_t node, std::uint64_t passes) const
+    -> std::uint32_t {
+    if (levels < 64 && (passes >> levels) != 0) {
+      throw std::out_of_range("more passes than the table has levels for");
+    }
+    for (std::size_t level = 0; passes != 0; level++, passes >>= 1) {
+      if ((passes & 1) != 0) {
+        node = jumps[level * nodes + node];
+      }
+    }
+    return node;
+  }
 
-    return std::accumulate(
-      std::ranges::begin(steps), std::ranges::end(steps), 1ull,
-      [](auto m, auto n) { return m / std::gcd(m, n) * n; });
+  auto pass_table::after_steps(graph const& g,
+                               std::span<instruction const> instructions,
+                               std::uint32_t node, std::uint64_t steps) const
+    -> std::uint32_t {
+    node = after_passes(node, steps / period);
+    for (std::uint64_t offset = 0; offset < steps % period; offset++) {
+      node = g.next(node, instructions[offset]);
+    }
+    return node;
   }
 
-  auto solution(std::istream& input)
-    -> std::pair<std::function<std::string()>,
-                 std::function<std::string()>> const {
-    const auto instructions = std::ranges::views::istream<instruction>(input) |
-      std::ranges::to<std::vector<instruction>>();
+  /* skip the largest runs of passes that visit no end node, the pass the
+   * node is left in then holds the first hit
+   */
+  auto pass_table::first_hit(std::uint32_t node) const
+    -> std::optional<std::uint64_t> {
+    // the pass starts repeat within nodes passes, so this covers all of them
+    if (!hits[(levels - 1) * std::size_t { nodes } + node]) {
+      return std::nullopt;
+    }
+
+    std::uint64_t passes = 0;
+    for (auto level = levels; level-- > 0;) {
+      if (!hits[level * std::size_t { nodes } + node]) {
+        node = jumps[level * std::size_t { nodes } + node];
+        passes += std::uint64_t { 1 } << level;
+      }
+    }
+
+    auto offset = hit_offsets[hit_starts[node]];
+    constexpr auto max_steps = std::numeric_limits<std::uint64_t>::max();
+    if (passes > (max_steps - offset) / period) {
+      throw std::overflow_error("first hit does not fit in 64 bits");
+    }
+    return passes * period + offset;
+  }
+
+  /* the walk only repeats at the start of a pass, so the cycle is found on
+   * the pass start nodes, which repeat within nodes passes
+   */
+  auto pass_table::cycle_of(std::uint32_t node) const -> walk_cycle {
+    constexpr auto unseen = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> seen(nodes, unseen);
+    std::vector<std::uint32_t> pass_starts;
+    while (seen[node] == unseen) {
+      seen[node] = static_cast<std::uint32_t>(pass_starts.size());
+      pass_starts.push_back(node);
+      node = jumps[node];
+    }
+
+    walk_cycle walk { .tail = seen[node] * period,
+                      .period = (pass_starts.size() - seen[node]) * period };
+    for (std::uint64_t pass = 0; pass < pass_starts.size(); pass++) {
+      auto start = pass_starts[pass];
+      for (auto i = hit_starts[start]; i < hit_starts[start + 1]; i++) {
+        auto step = pass * period + hit_offsets[i];
+        if (step < walk.tail) {
+          walk.tail_hits.push_back(step);
+        } else {
+          walk.cycle_hits.push_back(step - walk.tail);
+        }
+      }
+    }
+    return walk;
+  }
+
+  auto walk_cycle::is_hit(std::uint64_t step) const -> bool {
+    if (step < tail) {
+      return std::ranges::binary_search(tail_hits, step);
+    }
+    return std::ranges::binary_search(cycle_hits, (step - tail) % period);
+  }
+
+  using uint128 = unsigned __int128;
+
+  auto gcd(uint128 a, uint128 b) -> uint128 {
+    while (b != 0) {
+      a = std::exchange(b, a % b);
+    }
+    return a;
+  }
+
+  // inverse of a modulo m, a and m being coprime and below 2^64
+  auto inverse(uint128 a, uint128 m) -> uint128 {
+    __int128 r0 = m;
+    __int128 r1 = a % m;
+    __int128 t0 = 0;
+    __int128 t1 = 1;
+    while (r1 != 0) {
+      auto q = r0 / r1;
+      r0 = std::exchange(r1, r0 - q * r1);
+      t0 = std::exchange(t1, t0 - q * t1);
+    }
+    return static_cast<uint128>(t0 < 0 ? t0 + m : t0);
+  }
+
+  /* x = a (mod m) and x = b (mod n) as x = c (mod lcm(m, n)), with m at most
+   * 2^64 and n below it so that every product fits in 128 bits
+   * where:
+   *  x = a + m * k, and m * k = b - a (mod n) is solvable when gcd(m, n)
+   *  divides b - a, giving k modulo n / gcd(m, n)
+   */
+  auto combine(uint128 a, uint128 m, uint128 b, uint128 n)
+    -> std::optional<uint128> {
+    auto g = gcd(m, n);
+    auto diff = (b + n - a % n) % n;
+    if (diff % g != 0) {
+      return std::nullopt;
+    }
+    auto n_g = n / g;
+    auto k = diff / g % n_g * inverse(m / g % n_g, n_g) % n_g;
+    return a + m * k;
+  }
+
+  /* the steps before the longest tail are hits of that walk, so they are
+   * tried first, from there on every walk is in its cycle and the steps
+   * are solved as residues of the lcm of the periods
+   * once that lcm passes 2^64 every residue left is a single candidate, the
+   * remaining walks are then checked directly
+   */
+  auto first_meeting(std::span<walk_cycle const> walks)
+    -> std::optional<std::uint64_t> {
+    constexpr uint128 max_steps = std::numeric_limits<std::uint64_t>::max();
+
+    // no walk at all is trivially done
+    if (walks.empty()) {
+      return 0;
+    }
+
+    auto const& longest = std::ranges::max(walks, {}, &walk_cycle::tail);
+    for (auto step : longest.tail_hits) {
+      if (std::ranges::all_of(
+            walks, [&](auto const& walk) { return walk.is_hit(step); })) {
+        return step;
+      }
+    }
+
+    std::vector<uint128> residues { 0 };
+    uint128 modulus = 1;
+    auto walk = std::begin(walks);
+    for (; walk != std::end(walks) && modulus <= max_steps; walk++) {
+      std::vector<uint128> next;
+      for (auto residue : residues) {
+        for (auto hit : walk->cycle_hits) {
+          auto walk_residue = (walk->tail + hit) % walk->period;
+          if (auto combined =
+                combine(residue, modulus, walk_residue, walk->period)) {
+            next.push_back(*combined);
+          }
+        }
+      }
+
+      modulus = modulus / gcd(modulus, walk->period) * walk->period;
+      std::ranges::sort(next);
+      auto [last, _] = std::ranges::unique(next);
+      next.erase(last, std::end(next));
+      // any step that fits in 64 bits has its residue below 2^64 as well
+      std::erase_if(next, [&](uint128 residue) { return residue > max_steps; });
+      residues = std::move(next);
+      if (residues.empty()) {
+        return std::nullopt;
+      }
+    }
+
+    // the first step at or after the longest tail in each residue class
+    uint128 start = longest.tail;
+    std::optional<std::uint64_t> first;
+    bool overflow = false;
+    for (auto residue : residues) {
+      auto step = residue >= start
+        ? residue
+        : residue + (start - residue + modulus - 1) / modulus * modulus;
+      if (step > max_steps) {
+        overflow = true;
+        continue;
+      }
+      if (std::all_of(walk, std::end(walks), [&](auto const& rest) {
+            return rest.is_hit(static_cast<std::uint64_t>(step));
+          })) {
+        first = std::min(first.value_or(max_steps),
+                         static_cast<std::uint64_t>(step));
+      }
+    }
+
+    if (!first && overflow) {
+      throw std::overflow_error("first meeting does not fit in 64 bits");
+    }
+    return first;
+  }
+
+  auto network::from_stream(std::istream& input) -> network {
+    auto instructions = std::make_shared<std::vector<instruction>>(
+      std::ranges::views::istream<instruction>(input) |
+      std::ranges::to<std::vector<instruction>>());
     const auto entries = std::ranges::views::istream<graph::entry>(input) |
       std::ranges::to<std::vector<graph::entry>>();
-    const auto g = graph::from_entries(entries);
 
+    return { .instructions = *instructions,
+             .nodes = graph::from_entries(entries),
+             .storage = std::move(instructions) };
+  }
+
+  struct snapshot_header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t nodes;
+    std::uint64_t instructions;
+  };
+
+  static constexpr std::array<char, 8> snapshot_magic = { 'A', 'O', 'C', 'D',
+                                                          '8', 'N', 'E', 'T' };
+  static constexpr std::uint32_t snapshot_version = 1;
+
+  // byte offsets of the arrays of a snapshot, and its total size
+  struct snapshot_layout {
+    std::size_t instructions, names, links, size;
+
+    snapshot_layout(std::uint32_t nodes, std::uint64_t steps) {
+      auto align = [](std::size_t offset) { return (offset + 3) / 4 * 4; };
+      instructions = sizeof(snapshot_header);
+      names = align(instructions + steps);
+      links = align(names + nodes * sizeof(std::uint16_t));
+      size = links + 2 * std::size_t { nodes } * sizeof(std::uint32_t);
+    }
+  };
+
+  auto network::write_snapshot(std::ostream& output) const -> void {
+    const snapshot_header header { .magic = snapshot_magic,
+                                   .version = snapshot_version,
+                                   .nodes = nodes.size(),
+                                   .instructions = instructions.size() };
+    const snapshot_layout layout(header.nodes, header.instructions);
+
+    std::size_t written = 0;
+    auto write = [&](std::size_t offset, std::span<std::byte const> bytes) {
+      constexpr std::array<char, 4> padding {};
+      output.write(std::data(padding),
+                   static_cast<std::streamsize>(offset - written));
+      output.write(reinterpret_cast<char const*>(std::data(bytes)),
+                   static_cast<std::streamsize>(std::size(bytes)));
+      written = offset + std::size(bytes);
+    };
+
+    write(0, std::as_bytes(std::span { &header, 1 }));
+    write(layout.instructions, std::as_bytes(instructions));
+    write(layout.names, std::as_bytes(nodes.names));
+    write(layout.links, std::as_bytes(nodes.links));
+    if (!output) {
+      throw std::runtime_error("failed to write the snapshot");
+    }
+  }
+
+  auto network::from_snapshot(std::string const& path) -> network {
+    auto fail = [&](std::string const& reason) {
+      return std::runtime_error("snapshot " + path + ": " + reason);
+    };
+
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw fail(std::strerror(errno));
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) != 0 ||
+        static_cast<std::size_t>(status.st_size) < sizeof(snapshot_header)) {
+      ::close(fd);
+      throw fail("not a snapshot");
+    }
+    auto size = static_cast<std::size_t>(status.st_size);
+    auto* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      throw fail(std::strerror(errno));
+    }
+    std::shared_ptr<void const> mapping(
+      data, [size](void const* p) { ::munmap(const_cast<void*>(p), size); });
+
+    auto const* bytes = static_cast<char const*>(data);
+    snapshot_header header {};
+    std::memcpy(&header, bytes, sizeof(header));
+    if (header.magic != snapshot_magic || header.version != snapshot_version ||
+        header.instructions > size ||
+        snapshot_layout(header.nodes, header.instructions).size != size) {
+      throw fail("not a snapshot");
+    }
+    const snapshot_layout layout(header.nodes, header.instructions);
+
+    const std::span instructions {
+      reinterpret_cast<instruction const*>(bytes + layout.instructions),
+      header.instructions
+    };
+    const std::span names {
+      reinterpret_cast<std::uint16_t const*>(bytes + layout.names),
+      header.nodes
+    };
+    const std::span links {
+      reinterpret_cast<std::uint32_t const*>(bytes + layout.links),
+      2 * std::size_t { header.nodes }
+    };
+
+    // a bad id would walk out of the arrays, so the bounds are checked once
+    if (!std::ranges::all_of(instructions,
+                             [](instruction i) {
+                               return i == instruction::left ||
+                                 i == instruction::right;
+                             }) ||
+        !std::ranges::all_of(
+          names, [](std::uint16_t code) { return code < name_codes; }) ||
+        !std::ranges::all_of(links, [&](std::uint32_t node) {
+          return node < header.nodes;
+        })) {
+      throw fail("corrupted snapshot");
+    }
+
+    return { .instructions = instructions,
+             .nodes = { .names = names, .links = links, .storage = mapping },
+             .storage = mapping };
+  }
+
+  auto solve(network const& net)
+    -> std::pair<std::function<std::string()>,
+                 std::function<std::string()>> const {
     const auto pt1 = [=]() -> std::string {
-      return std::to_string(
-        g.traverse(instructions, std::regex { "AAA" }, std::regex { "ZZZ" }));
+      return std::to_string(net.nodes.traverse(
+        net.instructions, std::regex { "AAA" }, std::regex { "ZZZ" }));
     };
 
     const auto pt2 = [=]() -> std::string {
-      return std::to_string(
-        g.traverse(instructions, std::regex { ".*A$" }, std::regex { ".*Z$" }));
-
-      return "not implemented";
+      return std::to_string(net.nodes.traverse(
+        net.instructions, std::regex { ".*A$" }, std::regex { ".*Z$" }));
     };
 
     return { pt1, pt2 };
   }
 
+  auto solution(std::istream& input)
+    -> std::pair<std::function<std::string()>,
+                 std::function<std::string()>> const {
+    return solve(network::from_stream(input));
+  }
+
   // boring parsing stuff
   auto operator>>(std::istream& is, instruction& i) -> std::istream& {
     char c;
@@ -1,27 +1,163 @@
 #include <aoc/day9.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <istream>
 #include <iterator>
+#include <limits>
 #include <numeric>
 #include <print>
 #include <ranges>
 #include <sstream>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
 namespace aoc::day9 {
-  auto interpolate(report const& r) -> std::uint64_t {
-    auto result = std::vector<std::uint64_t> {};
-    std::adjacent_difference(std::begin(r), std::end(r),
-                             std::back_inserter(result));
-    result.erase(std::begin(result));
-    auto all_zero =
-      !std::ranges::any_of(result, [](auto const& x) { return x != 0; });
-
-    return r.back() + (all_zero ? 0 : interpolate(result));
+  /* extrapolating a report of length n through its difference table is
+   * the same as summing its values with fixed signed binomial weights
+   *   next = sum (-1)^(n - 1 - i) C(n, i) a_i
+   *   prev = sum (-1)^i C(n, i + 1) a_i
+   * the weights are tabled for every length up to max_length, whose binomials
+   * still fit in 64 bits
+   */
+  static constexpr std::size_t max_length = 64;
+
+  using weight_table =
+    std::array<std::array<std::int64_t, max_length + 1>, max_length + 1>;
+
+  static constexpr weight_table binomials = [] {
+    weight_table c {};
+    for (std::size_t n = 0; n <= max_length; n++) {
+      c[n][0] = 1;
+      for (std::size_t k = 1; k <= n; k++) {
+        c[n][k] = c[n - 1][k - 1] + (k < n ? c[n - 1][k] : 0);
+      }
+    }
+    return c;
+  }();
+
+  static constexpr weight_table next_weights = [] {
+    weight_table w {};
+    for (std::size_t n = 1; n <= max_length; n++) {
+      for (std::size_t i = 0; i < n; i++) {
+        w[n][i] = (n - 1 - i) % 2 == 0 ? binomials[n][i] : -binomials[n][i];
+      }
+    }
+    return w;
+  }();
+
+  static constexpr weight_table prev_weights = [] {
+    weight_table w {};
+    for (std::size_t n = 1; n <= max_length; n++) {
+      for (std::size_t i = 0; i < n; i++) {
+        w[n][i] = i % 2 == 0 ? binomials[n][i + 1] : -binomials[n][i + 1];
+      }
+    }
+    return w;
+  }();
+
+  static_assert(binomials[max_length][max_length / 2] == 1832624140942590534);
+
+  // the weights of a row add up, in absolute value, to at most 2^64
+  static_assert([] {
+    for (auto const* table : { &next_weights, &prev_weights }) {
+      for (auto const& row : *table) {
+        unsigned __int128 total = 0;
+        for (auto weight : row) {
+          total += weight < 0 ? -static_cast<__int128>(weight) : weight;
+        }
+        if (total > static_cast<unsigned __int128>(1) << 64) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }());
+
+  auto narrow(__int128 value) -> std::int64_t {
+    if (value < std::numeric_limits<std::int64_t>::min() ||
+        value > std::numeric_limits<std::int64_t>::max()) {
+      throw std::overflow_error("extrapolated value does not fit in 64 bits");
+    }
+    return static_cast<std::int64_t>(value);
+  }
+
+  /* the values are below 2^63 in absolute value and the weights of a row
+   * add up to at most 2^64, so the sum stays below 2^127 and is exact in
+   * 128 bits
+   */
+  auto weighted_sum(report const& r, weight_table const& weights)
+    -> std::int64_t {
+    auto const& row = weights[r.size()];
+    __int128 sum = 0;
+    for (std::size_t i = 0; i < r.size(); i++) {
+      sum += static_cast<__int128>(row[i]) * r[i];
+    }
+    return narrow(sum);
+  }
+
+  /* reports too long for the tables collapse their difference table in
+   * place down to the first entry of every level, the alternating sum of
+   * which is the value before the first, the value after the last is the
+   * same on the reversed report
+   * the differences can double at every level, so every step is checked
+   * and the report throws std::overflow_error as soon as one of them does
+   * not fit in 128 bits
+   */
+  auto collapse(report const& r, bool after_last) -> std::int64_t {
+    auto overflow = [] {
+      return std::overflow_error("difference table does not fit in 128 bits");
+    };
+
+    std::vector<__int128> levels(std::begin(r), std::end(r));
+    if (after_last) {
+      std::ranges::reverse(levels);
+    }
+    for (std::size_t level = 1; level < levels.size(); level++) {
+      for (auto i = levels.size() - 1; i >= level; i--) {
+        if (__builtin_sub_overflow(levels[i], levels[i - 1], &levels[i])) {
+          throw overflow();
+        }
+      }
+    }
+
+    __int128 sum = 0;
+    for (std::size_t level = 0; level < levels.size(); level++) {
+      if (level % 2 == 0
+            ? __builtin_add_overflow(sum, levels[level], &sum)
+            : __builtin_sub_overflow(sum, levels[level], &sum)) {
+        throw overflow();
+      }
+    }
+    return narrow(sum);
+  }
+
+  auto interpolate(report const& r) -> std::int64_t {
+    return r.size() <= max_length ? weighted_sum(r, next_weights)
+                                  : collapse(r, true);
+  }
+
+  auto interpolate_back(report const& r) -> std::int64_t {
+    return r.size() <= max_length ? weighted_sum(r, prev_weights)
+                                  : collapse(r, false);
+  }
+
+  /* the extrapolated values add up in 128 bits, which no input can
+   * overflow, and only the total has to fit in 64 bits
+   */
+  auto total(std::vector<std::int64_t> const& values) -> std::int64_t {
+    auto sum =
+      std::accumulate(std::begin(values), std::end(values), __int128 { 0 });
+    if (sum < std::numeric_limits<std::int64_t>::min() ||
+        sum > std::numeric_limits<std::int64_t>::max()) {
+      throw std::overflow_error("sum of the reports does not fit in 64 bits");
+    }
+    return static_cast<std::int64_t>(sum);
   }
 
   auto solution(std::istream& input)
@@ -32,25 +168,15 @@ namespace aoc::day9 {
 
     const auto pt1 = [=]() -> std::string {
       auto interpolated = reports | std::views::transform(interpolate) |
-        std::ranges::to<std::vector<std::uint64_t>>();
-      auto sum =
-        std::accumulate(std::begin(interpolated), std::end(interpolated), 0ULL,
-                        [](auto const& acc, auto const& x) { return acc + x; });
-      return std::to_string(sum);
+        std::ranges::to<std::vector<std::int64_t>>();
+      return std::to_string(total(interpolated));
     };
 
     const auto pt2 = [=]() -> std::string {
       auto interpolated_reverse = reports |
-        std::views::transform([](auto const& r) {
-                                    auto result = r;
-                                    std::ranges::reverse(result);
-                                    return interpolate(result);
-                                  }) |
-        std::ranges::to<std::vector<std::uint64_t>>();
-      auto sum = std::accumulate(
-        std::begin(interpolated_reverse), std::end(interpolated_reverse), 0ULL,
-        [](auto const& acc, auto const& x) { return acc + x; });
-      return std::to_string(sum);
+        std::views::transform(interpolate_back) |
+        std::ranges::to<std::vector<std::int64_t>>();
+      return std::to_string(total(interpolated_reverse));
     };
 
     return { pt1, pt2 };
@@ -64,14 +190,14 @@ namespace std {
     std::getline(is, line);
     std::istringstream iss { line };
 
-    std::ranges::copy(std::istream_iterator<std::uint64_t> { iss },
-                      std::istream_iterator<std::uint64_t> {},
+    std::ranges::copy(std::istream_iterator<std::int64_t> { iss },
+                      std::istream_iterator<std::int64_t> {},
                       std::back_inserter(r));
     return is;
   }
 
   auto operator<<(std::ostream& os, aoc::day9::report& r) -> std::ostream& {
-    std::ranges::copy(r, std::ostream_iterator<std::uint64_t> { os, " " });
+    std::ranges::copy(r, std::ostream_iterator<std::int64_t> { os, " " });
     return os;
   }
 } // namespace std
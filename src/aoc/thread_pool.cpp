@@ -0,0 +1,165 @@
+#include <aoc/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aoc {
+  namespace {
+    // pool and index of the worker running on this thread, if any
+    thread_local thread_pool const* current_pool = nullptr;
+    thread_local size_t current_index = 0;
+  } // namespace
+
+  thread_pool::thread_pool(size_t num_workers) {
+    num_workers = std::max<size_t>(1, num_workers);
+    for (size_t i = 0; i < num_workers; i++) {
+      queues.push_back(std::make_unique<task_queue>());
+    }
+    for (size_t i = 0; i < num_workers; i++) {
+      workers.emplace_back(
+        [this, i](std::stop_token const& stop) { worker_loop(stop, i); });
+    }
+  }
+
+  thread_pool::~thread_pool() {
+    for (auto& worker : workers) {
+      worker.request_stop();
+    }
+    wake.notify_all();
+  }
+
+  auto thread_pool::shared() -> thread_pool& {
+    static thread_pool pool { std::thread::hardware_concurrency() };
+    return pool;
+  }
+
+  auto thread_pool::worker_index() const -> size_t {
+    return current_pool == this ? current_index : size();
+  }
+
+  auto thread_pool::push(std::function<void()> task) -> void {
+    auto index = worker_index() < size()
+      ? worker_index()
+      : next_queue.fetch_add(1, std::memory_order_relaxed) % size();
+    {
+      std::scoped_lock lock { queues[index]->mutex };
+      queues[index]->tasks.push_front(std::move(task));
+    }
+    queued.fetch_add(1);
+    {
+      // pairs with the predicate check of the sleeping workers
+      std::scoped_lock lock { sleep_mutex };
+    }
+    wake.notify_one();
+  }
+
+  auto thread_pool::try_pop(size_t index)
+    -> std::optional<std::function<void()>> {
+    if (queued.load() == 0) {
+      return std::nullopt;
+    }
+    // own queue first (front), then steal from the others (back)
+    for (size_t k = 0; k < size(); k++) {
+      auto& queue = *queues[(index + k) % size()];
+      std::scoped_lock lock { queue.mutex };
+      if (queue.tasks.empty()) {
+        continue;
+      }
+      std::function<void()> task;
+      if (k == 0) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      } else {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      }
+      queued.fetch_sub(1);
+      return task;
+    }
+    return std::nullopt;
+  }
+
+  auto thread_pool::worker_loop(std::stop_token const& stop, size_t index)
+    -> void {
+    current_pool = this;
+    current_index = index;
+
+    while (!stop.stop_requested()) {
+      if (auto task = try_pop(index)) {
+        (*task)();
+        continue;
+      }
+      std::unique_lock lock { sleep_mutex };
+      wake.wait(lock, stop, [this]() { return queued.load() > 0; });
+    }
+  }
+
+  auto thread_pool::parallel_for(
+    size_t count, size_t min_grain,
+    std::function<void(size_t, size_t)> const& body) -> void {
+    // a few chunks per worker leave room for stealing to balance the load
+    auto chunks_wanted = 4 * size();
+    auto grain = std::max(
+      { min_grain, size_t { 1 }, (count + chunks_wanted - 1) / chunks_wanted });
+    if (count <= grain) {
+      body(0, count);
+      return;
+    }
+
+    auto chunks = (count + grain - 1) / grain;
+    /* the state is shared with the tasks, the caller may see the counter
+     * reach zero and return before the last task is done notifying through
+     * it. the first exception of the chunks is kept to be rethrown by the
+     * caller once they are all done
+     */
+    struct completion {
+      std::atomic<size_t> remaining;
+      std::mutex error_mutex;
+      std::exception_ptr error;
+    };
+    auto state = std::make_shared<completion>(chunks);
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+      push([&body, count, grain, state, chunk]() {
+        try {
+          body(chunk * grain, std::min(count, (chunk + 1) * grain));
+        } catch (...) {
+          std::scoped_lock lock { state->error_mutex };
+          if (!state->error) {
+            state->error = std::current_exception();
+          }
+        }
+        if (state->remaining.fetch_sub(1) == 1) {
+          state->remaining.notify_all();
+        }
+      });
+    }
+
+    /* a worker waiting on a nested call helps with the queued tasks instead
+     * of blocking, other threads just wait so that worker_index() stays
+     * unique among the threads running the tasks
+     */
+    auto index = worker_index();
+    auto& remaining = state->remaining;
+    for (auto left = remaining.load(); left != 0; left = remaining.load()) {
+      if (auto task = index < size() ? try_pop(index) : std::nullopt) {
+        (*task)();
+      } else {
+        remaining.wait(left);
+      }
+    }
+
+    // every chunk is done, nothing writes the error anymore
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+  }
+} // namespace aoc
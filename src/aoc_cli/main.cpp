@@ -1,3 +1,4 @@
+#include <aoc/day8.hpp>
 #include <aoc_cli/days.hpp>
 
 #include <algorithm>
@@ -18,6 +19,10 @@ auto main(int argc, char* argv[]) -> int {
     ("day", "Day to run", cxxopts::value<int>()->default_value("1"))
     ("part", "Part to run", cxxopts::value<int>()->default_value("1"))
     ("help", "std::println help")
+    ("emit-snapshot", "Write the parsed day 8 network to a snapshot file",
+     cxxopts::value<std::string>())
+    ("snapshot", "Read the day 8 network from a snapshot file",
+     cxxopts::value<std::string>())
     ("input", "Input file", cxxopts::value<std::string>()->default_value(""));
   // clang-format on
   options.parse_positional({ "input" });
@@ -42,7 +47,24 @@ auto main(int argc, char* argv[]) -> int {
     std::exit(1);
   }
 
-  auto [part1, part2] = aoc_cli::days.at(day)(*input);
+  if ((result.count("emit-snapshot") || result.count("snapshot")) &&
+      day != 8) {
+    std::println("Snapshots are only available for day 8");
+    std::exit(1);
+  }
+
+  if (result.count("emit-snapshot")) {
+    auto path = result["emit-snapshot"].as<std::string>();
+    std::ofstream output(path, std::ios::binary);
+    aoc::day8::network::from_stream(*input).write_snapshot(output);
+    std::println("Snapshot written to {}", path);
+    return 0;
+  }
+
+  auto [part1, part2] = result.count("snapshot")
+    ? aoc::day8::solve(aoc::day8::network::from_snapshot(
+        result["snapshot"].as<std::string>()))
+    : aoc_cli::days.at(day)(*input);
   auto res = part == 1 ? part1() : part2();
   std::println("{}", res);
 
@@ -0,0 +1,126 @@
+#include "test.hpp"
+
+#include <aoc/day3.hpp>
+
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+  using aoc::day3::totals;
+  using aoc::test::check;
+
+  auto operator==(totals const& a, totals const& b) -> bool {
+    return a.part_numbers == b.part_numbers && a.gear_ratios == b.gear_ratios;
+  }
+
+  auto join(std::vector<std::string> const& rows) -> std::string {
+    std::string text;
+    for (auto const& row : rows) {
+      text += row + '\n';
+    }
+    return text;
+  }
+
+  /* a random schematic of 1 to 3 digit numbers, symbols and dots, around
+   * every multiple of 256 rows a gear is planted on the boundary row with
+   * one number above and one below it, and a number right above the
+   * boundary only touches a symbol on the row below
+   */
+  auto random_schematic(std::mt19937_64& rng, size_t height, size_t width)
+    -> std::vector<std::string> {
+    std::vector<std::string> rows(height, std::string(width, '.'));
+    for (auto& row : rows) {
+      for (size_t j = 0; j < width;) {
+        auto pick = rng() % 10;
+        if (pick < 3) {
+          for (auto digits = rng() % 3 + 1; digits-- > 0 && j < width; j++) {
+            row[j] = static_cast<char>('0' + rng() % 10);
+          }
+          j++;
+        } else if (pick < 5) {
+          row[j++] = "*#+$"[rng() % 4];
+        } else {
+          j++;
+        }
+      }
+    }
+    for (size_t edge = 256; edge + 1 < height; edge += 256) {
+      rows[edge - 1].replace(0, 8, "12....7.");
+      rows[edge].replace(0, 8, "..*....#");
+      rows[edge + 1].replace(0, 8, "...34...");
+    }
+    return rows;
+  }
+
+  const std::string example = R"(467..114..
+...*......
+..35..633.
+......#...
+617*......
+.....+.58.
+..592.....
+......755.
+...$.*....
+.664.598..
+)";
+
+  const aoc::test::test_case example_solution {
+    "day3 example", [] {
+      std::istringstream input { example };
+      auto [pt1, pt2] = aoc::day3::solution(input);
+      check(std::pair { pt1(), pt2() } ==
+              std::pair<std::string, std::string> { "4361", "467835" },
+            "both parts");
+    }
+  };
+
+  const aoc::test::test_case example_scan {
+    "day3 scan streams the example row by row", [] {
+      std::istringstream input { example };
+      std::vector<size_t> seen;
+      totals last;
+      auto result =
+        aoc::day3::scan(input, [&](size_t row, totals const& running) {
+          seen.push_back(row);
+          last = running;
+        });
+      check(result == totals { 4361, 467835 }, "example totals");
+      check(seen == std::vector<size_t> { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 },
+            "every row is resolved once and in order");
+      check(last == result, "the last partial totals are the result");
+
+      std::istringstream empty;
+      check(aoc::day3::scan(empty) == totals {}, "empty schematic");
+    }
+  };
+
+  /* schematics past the parallel threshold of the solution are split in
+   * bands of at least 256 rows, numbers and gears across the band edges
+   * must be counted once, exactly as the labelled whole schematic does
+   */
+  const aoc::test::test_case bands_agree_with_labels {
+    "day3 banded scans agree with the labelled schematic", [] {
+      std::mt19937_64 rng { 3 };
+      for (auto height : { size_t { 255 }, size_t { 4096 }, size_t { 5000 } }) {
+        auto rows = random_schematic(rng, height, 70);
+        auto expected = aoc::day3::label_totals(rows);
+
+        check(aoc::day3::scan_bands(rows) == expected, "scan_bands");
+
+        std::istringstream stream { join(rows) };
+        check(aoc::day3::scan(stream) == expected, "scan");
+
+        std::istringstream input { join(rows) };
+        auto [pt1, pt2] = aoc::day3::solution(input);
+        check(std::pair { pt1(), pt2() } ==
+                std::pair { std::to_string(expected.part_numbers),
+                            std::to_string(expected.gear_ratios) },
+              "both parts");
+      }
+    }
+  };
+} // namespace
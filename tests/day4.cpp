@@ -0,0 +1,71 @@
+#include "test.hpp"
+
+#include <aoc/day4.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+  using aoc::test::check;
+
+  // both parts of the solution, each on its own copy of the input
+  auto solve(std::string const& text) -> std::pair<std::string, std::string> {
+    std::istringstream pt1_input { text };
+    std::istringstream pt2_input { text };
+    return { aoc::day4::solution(pt1_input).first(),
+             aoc::day4::solution(pt2_input).second() };
+  }
+
+  const aoc::test::test_case example {
+    "day4 example", [] {
+      auto text = R"(Card 1: 41 48 83 86 17 | 83 86  6 31 17  9 48 53
+Card 2: 13 32 20 16 61 | 61 30 68 82 17 32 24 19
+Card 3:  1 21 53 59 44 | 69 82 63 72 16 21 14  1
+Card 4: 41 92 73 84 69 | 59 84 76 51 58  5 54 83
+Card 5: 87 83 26 28 32 | 88 30 70 12 93 22 82 36
+Card 6: 31 18 13 56 72 | 74 77 10 23 35 67 36 11
+)";
+      check(solve(text) == std::pair<std::string, std::string> { "13", "30" },
+            "both parts");
+    }
+  };
+
+  const aoc::test::test_case every_number {
+    "day4 card with every number from 0 to 127", [] {
+      std::string numbers;
+      for (int number = 0; number < 128; number++) {
+        numbers += " " + std::to_string(number);
+      }
+      // the first card wins a copy of each of the 128 cards after it
+      auto text = "Card 1:" + numbers + " |" + numbers + "\n";
+      for (int card = 2; card <= 129; card++) {
+        text += "Card " + std::to_string(card) + ": 1 | 2\n";
+      }
+
+      std::istringstream pt2_input { text };
+      check(aoc::day4::solution(pt2_input).second() == "257",
+            "128 cards won ahead");
+
+      bool thrown = false;
+      try {
+        std::istringstream pt1_input { text };
+        static_cast<void>(aoc::day4::solution(pt1_input).first());
+      } catch (std::overflow_error const&) {
+        thrown = true;
+      }
+      check(thrown, "2^127 points do not fit in 64 bits");
+
+      // 64 hits are still worth exactly 2^63 points
+      std::string low_numbers;
+      for (int number = 0; number < 64; number++) {
+        low_numbers += " " + std::to_string(number);
+      }
+      std::istringstream low_input { "Card 1:" + low_numbers + " |" +
+                                     low_numbers + "\n" };
+      check(aoc::day4::solution(low_input).first() == "9223372036854775808",
+            "64 hits");
+    }
+  };
+} // namespace
@@ -0,0 +1,156 @@
+#include "test.hpp"
+
+#include <aoc/day5.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+  using aoc::test::check;
+
+  constexpr auto no_seed = std::numeric_limits<std::uint64_t>::max();
+
+  const std::string maps = R"(
+seed-to-soil map:
+50 98 2
+52 50 48
+)";
+
+  const aoc::test::test_case empty_seed_intervals {
+    "day5 map_intervals without seeds", [] {
+      auto without_seeds = aoc::day5::almanac::from_str("seeds:\n" + maps);
+      check(without_seeds.map_intervals(without_seeds.seed_intervals()) ==
+              no_seed,
+            "no seed at all maps to the sentinel");
+      check(without_seeds.map_seeds(without_seeds.seeds) == no_seed,
+            "map_seeds agrees on the sentinel");
+
+      auto empty_ranges = aoc::day5::almanac::from_str("seeds: 79 0 55 0\n" +
+                                                       maps);
+      check(empty_ranges.map_intervals(empty_ranges.seed_intervals()) ==
+              no_seed,
+            "empty seed ranges map to the sentinel");
+    }
+  };
+
+  /* small random almanacs, the entries are free to overlap and to collide
+   * on their destinations, so most of the fused maps are not bijective
+   */
+  auto random_almanac(std::mt19937_64& rng) -> std::string {
+    auto value = [&](std::uint64_t bound) { return rng() % bound; };
+    auto text = std::string { "seeds:" };
+    for (auto pairs = value(4); pairs-- > 0;) {
+      text += " " + std::to_string(value(120)) + " " +
+        std::to_string(value(30));
+    }
+    text += "\n";
+    for (auto map = value(4) + 1; map-- > 0;) {
+      text += "\nx-to-y map:\n";
+      for (auto count = value(5); count-- > 0;) {
+        text += std::to_string(value(150)) + " " + std::to_string(value(150)) +
+          " " + std::to_string(value(40) + 1) + "\n";
+      }
+    }
+    return text;
+  }
+
+  const aoc::test::test_case inverse_mode {
+    "day5 lowest_location_inverse agrees with brute force", [] {
+      std::mt19937_64 rng { 5 };
+      for (int round = 0; round < 3000; round++) {
+        auto text = random_almanac(rng);
+        auto almanac = aoc::day5::almanac::from_str(std::string { text });
+        auto narrow_almanac =
+          aoc::day5::basic_almanac<std::uint32_t>::from_str(std::move(text));
+        auto intervals = almanac.seed_intervals();
+
+        std::vector<std::uint64_t> seeds;
+        for (auto [start, end] : intervals) {
+          for (auto seed = start; seed < end; seed++) {
+            seeds.push_back(static_cast<std::uint64_t>(seed));
+          }
+        }
+        auto expected = no_seed;
+        for (auto seed : seeds) {
+          for (auto const& map : almanac.maps) {
+            seed = map.search(seed);
+          }
+          expected = std::min(expected, seed);
+        }
+
+        check(almanac.map_seeds(seeds) == expected, "fused map_seeds");
+        check(almanac.map_intervals(intervals) == expected, "map_intervals");
+        check(almanac.lowest_location_inverse(intervals).value_or(no_seed) ==
+                expected,
+              "lowest_location_inverse");
+
+        // the 32 bit almanac, with its own sentinel
+        auto widen = [](std::uint32_t value) {
+          return value == std::numeric_limits<std::uint32_t>::max()
+            ? no_seed
+            : std::uint64_t { value };
+        };
+        check(widen(narrow_almanac.map_seeds(narrow_almanac.seeds)) ==
+                widen(static_cast<std::uint32_t>(
+                  almanac.map_seeds(almanac.seeds))),
+              "32 bit map_seeds");
+        check(widen(narrow_almanac.map_intervals(
+                narrow_almanac.seed_intervals())) == expected,
+              "32 bit map_intervals");
+      }
+    }
+  };
+
+  // both parts of the solution on the almanac text
+  auto solve(std::string const& text) -> std::pair<std::string, std::string> {
+    std::istringstream input { text };
+    auto [pt1, pt2] = aoc::day5::solution(input);
+    return { pt1(), pt2() };
+  }
+
+  const aoc::test::test_case almanac_width {
+    "day5 solution picks a width that holds every location", [] {
+      auto example = R"(seeds: 79 14 55 13
+
+seed-to-soil map:
+50 98 2
+52 50 48
+
+soil-to-fertilizer map:
+0 15 37
+37 52 2
+39 0 15
+)";
+      check(solve(example) ==
+              std::pair<std::string, std::string> { "52", "57" },
+            "the example fits in 32 bits");
+
+      auto wide = "seeds: 11 1\n\nseed-to-soil map:\n4294967295 10 2\n";
+      check(solve(wide) ==
+              std::pair<std::string, std::string> { "1", "4294967296" },
+            "an entry ending past 2^32 takes 64 bits");
+
+      auto sentinel = std::to_string(no_seed);
+      auto no_seeds = std::pair { sentinel, sentinel };
+      check(solve("seeds:\n" + maps) == no_seeds, "32 bit sentinel");
+      check(solve("seeds:\n\nseed-to-soil map:\n5000000000 0 1\n") ==
+              no_seeds,
+            "64 bit sentinel");
+
+      bool thrown = false;
+      try {
+        static_cast<void>(aoc::day5::almanac::from_str(
+          "seeds: 1 1\n\nseed-to-soil map:\n18446744073709551615 0 2\n"));
+      } catch (std::overflow_error const&) {
+        thrown = true;
+      }
+      check(thrown, "entries past the end of the domain are rejected");
+    }
+  };
+} // namespace
@@ -0,0 +1,72 @@
+#include "test.hpp"
+
+#include <aoc/day6.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+  using aoc::test::check;
+
+  auto solve(std::string const& text) -> std::pair<std::string, std::string> {
+    std::istringstream input { text };
+    auto [pt1, pt2] = aoc::day6::solution(input);
+    return { pt1(), pt2() };
+  }
+
+  const aoc::test::test_case example {
+    "day6 example", [] {
+      auto text = "Time:      7  15   30\nDistance:  9  40  200\n";
+      check(solve(text) ==
+              std::pair<std::string, std::string> { "288", "71503" },
+            "both parts");
+    }
+  };
+
+  /* times past 64 bits, with distances k * (time - k) so that exactly the
+   * holds k + 1 to time - k - 1 win
+   */
+  const aoc::test::test_case wide_times {
+    "day6 times past 64 bits", [] {
+      using aoc::day6::count_wins;
+      using aoc::day6::value;
+
+      auto time = (value { 1 } << 70) + 5;
+      check(count_wins(time, 0) == time - 1, "zero distance");
+      for (value k : { value { 1 }, value { 12345 }, value { 1 } << 50,
+                       value { 1 } << 57 }) {
+        check(count_wins(time, k * (time - k)) == time - 2 * k - 1,
+              "distance on a hold");
+        check(count_wins(time, k * (time - k) - 1) == time - 2 * k + 1,
+              "distance just below a hold");
+      }
+
+      // 2 * (max - 2) overflows, so it beats every 128 bit distance
+      auto max = ~value { 0 };
+      check(count_wins(max, 0) == max - 1, "128 bit time");
+      check(count_wins(max, max) == max - 3, "128 bit distance");
+      check(count_wins(value { 1 } << 64, max) == 0, "no wins");
+
+      check(solve("Time: 1267650600228229401496703205376\nDistance: 0\n") ==
+              std::pair<std::string, std::string> {
+                "1267650600228229401496703205375",
+                "1267650600228229401496703205375" },
+            "both parts");
+
+      bool threw = false;
+      try {
+        std::istringstream input {
+          "Time: 1267650600228229401496703205376 "
+          "1267650600228229401496703205376\nDistance: 0 0\n"
+        };
+        auto [pt1, pt2] = aoc::day6::solution(input);
+        pt1();
+      } catch (std::overflow_error const&) {
+        threw = true;
+      }
+      check(threw, "product of the wins overflows");
+    }
+  };
+} // namespace
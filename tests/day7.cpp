@@ -0,0 +1,134 @@
+#include "test.hpp"
+
+#include <aoc/day7.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <set>
+#include <string>
+
+namespace {
+  using aoc::test::check;
+
+  // whether part 1 of the solution rejects the input
+  auto rejects(std::string const& text) -> bool {
+    std::istringstream input { text };
+    try {
+      aoc::day7::solution(input).first();
+    } catch (std::invalid_argument const&) {
+      return true;
+    }
+    return false;
+  }
+
+  const aoc::test::test_case malformed_lines {
+    "day7 malformed lines are rejected", [] {
+      check(!rejects("32T3K 765\n\nT55J5 684\n"), "blank lines are skipped");
+      check(rejects("32T3K 765\nT55J5 \n"), "hand without a bid");
+      check(rejects("32T3K 765\nT55J5\n"), "hand without a space");
+      check(rejects("32T3K 76x\n"), "bid with trailing garbage");
+      check(rejects("32T3K4 765\n"), "hand of 6 cards");
+      check(rejects("AAAAAAAAAAAAAAAA 765\n"), "hand of 16 cards");
+      check(rejects("32T3 765\n"), "hand of 4 cards");
+      check(rejects("32X3K 765\n"), "unknown card");
+    }
+  };
+
+  /* random inserts and erases on a leaderboard, checked against the part of
+   * the solution with the same rules
+   */
+  template <typename Board>
+  auto check_leaderboard(bool jokers) -> void {
+    std::mt19937 rng { 7 };
+    Board board;
+    std::map<std::string, std::uint32_t> hands;
+    for (int step = 0; step < 2000; step++) {
+      if (rng() % 3 == 0 && !hands.empty()) {
+        auto it = std::next(std::begin(hands), rng() % hands.size());
+        check(board.erase(it->first), "erase a hand in the leaderboard");
+        hands.erase(it);
+      } else {
+        std::string hand;
+        for (int card = 0; card < 5; card++) {
+          hand += "23456789TJQKA"[rng() % 13];
+        }
+        auto bid = static_cast<std::uint32_t>(rng() % 1000 + 1);
+        board.insert(hand, bid);
+        hands[hand] = bid;
+      }
+
+      if (step % 100 == 99) {
+        std::string text;
+        for (auto const& [hand, bid] : hands) {
+          text += hand + " " + std::to_string(bid) + "\n";
+        }
+        std::istringstream input { text };
+        auto [pt1, pt2] = aoc::day7::solution(input);
+        check(std::to_string(board.total_winnings()) ==
+                (jokers ? pt2() : pt1()),
+              "total winnings");
+        check(board.size() == hands.size(), "size");
+      }
+    }
+
+    bool rejected = false;
+    try {
+      board.insert("2345X", 1);
+    } catch (std::invalid_argument const&) {
+      rejected = true;
+    }
+    check(rejected, "unknown card");
+  }
+
+  const aoc::test::test_case leaderboard_updates {
+    "day7 leaderboard agrees with the solution", [] {
+      check_leaderboard<aoc::day7::leaderboard>(false);
+      check_leaderboard<aoc::day7::joker_leaderboard>(true);
+    }
+  };
+
+  /* inputs over 512 KiB are parsed, ranked and summed on the thread pool,
+   * the hands are distinct so the leaderboards rank them the same way
+   */
+  const aoc::test::test_case large_inputs {
+    "day7 large inputs agree with the leaderboards", [] {
+      std::mt19937 rng { 11 };
+      std::set<std::string> seen;
+      std::string text;
+      aoc::day7::leaderboard board;
+      aoc::day7::joker_leaderboard joker_board;
+      while (seen.size() < 80000) {
+        std::string hand;
+        for (int card = 0; card < 5; card++) {
+          hand += "23456789TJQKA"[rng() % 13];
+        }
+        if (!seen.insert(hand).second) {
+          continue;
+        }
+        auto bid = static_cast<std::uint32_t>(rng() % 1000 + 1);
+        board.insert(hand, bid);
+        joker_board.insert(hand, bid);
+        text += hand + " " + std::to_string(bid) + "\n";
+      }
+      check(text.size() > 8 * (1 << 16), "input takes the pooled path");
+
+      // both parts read the whole stream, so each gets its own
+      std::istringstream input { text };
+      check(aoc::day7::solution(input).first() ==
+              std::to_string(board.total_winnings()),
+            "part 1");
+      std::istringstream joker_input { text };
+      check(aoc::day7::solution(joker_input).second() ==
+              std::to_string(joker_board.total_winnings()),
+            "part 2");
+
+      auto middle = text.find('\n', text.size() / 2) + 1;
+      check(rejects(text.substr(0, middle) + "32T3K\n" + text.substr(middle)),
+            "malformed line in a large input");
+    }
+  };
+} // namespace
@@ -0,0 +1,132 @@
+#include "test.hpp"
+
+#include <aoc/day8.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+  using aoc::day8::decode_name;
+  using aoc::day8::first_meeting;
+  using aoc::day8::network;
+  using aoc::day8::node_set;
+  using aoc::day8::pass_table;
+  using aoc::day8::walk_cycle;
+  using aoc::test::check;
+
+  // a network of up to 12 nodes with 1 to max_period random instructions
+  auto random_network(std::mt19937_64& rng, std::uint64_t max_period)
+    -> network {
+    auto nodes = static_cast<std::uint32_t>(rng() % 12 + 1);
+    auto text = std::string {};
+    for (auto steps = rng() % max_period + 1; steps-- > 0;) {
+      text += rng() % 2 ? 'L' : 'R';
+    }
+    text += "\n\n";
+    for (std::uint32_t node = 0; node < nodes; node++) {
+      text += decode_name(static_cast<std::uint16_t>(node)) + " = (" +
+        decode_name(static_cast<std::uint16_t>(rng() % nodes)) + ", " +
+        decode_name(static_cast<std::uint16_t>(rng() % nodes)) + ")\n";
+    }
+    std::istringstream input { text };
+    return network::from_stream(input);
+  }
+
+  /* the lock step simulation and the cycle solver on small random
+   * networks, every walk starts at a random node and about a third of the
+   * nodes are ends
+   */
+  const aoc::test::test_case simulate_agrees_with_cycles {
+    "day8 simulate agrees with first_meeting", [] {
+      constexpr std::uint64_t max_steps = 200000;
+      std::mt19937_64 rng { 9 };
+      for (int round = 0; round < 3000; round++) {
+        auto net = random_network(rng, 4);
+        auto const& g = net.nodes;
+
+        node_set ends { g.size() };
+        std::vector<std::uint32_t> starts;
+        for (std::uint32_t node = 0; node < g.size(); node++) {
+          if (rng() % 3 == 0) {
+            ends.insert(node);
+          }
+          if (rng() % 3 == 0) {
+            starts.push_back(node);
+          }
+        }
+
+        auto passes = pass_table::from_graph(g, net.instructions, ends);
+        std::vector<walk_cycle> walks;
+        for (auto start : starts) {
+          walks.push_back(passes.cycle_of(start));
+        }
+        auto solved = first_meeting(walks);
+        auto simulated = g.simulate(net.instructions, starts, ends, max_steps);
+        check(simulated ? solved == simulated : !solved || *solved > max_steps,
+              "same first meeting");
+      }
+    }
+  };
+
+  /* binary lifting against walks of one step at a time, with periods on
+   * both sides of 256 so that the tables have from 56 to 63 levels
+   */
+  const aoc::test::test_case pass_table_lifting {
+    "day8 pass_table agrees with step by step walks", [] {
+      std::mt19937_64 rng { 46 };
+      for (int round = 0; round < 500; round++) {
+        auto net = random_network(rng, 300);
+        auto const& g = net.nodes;
+        auto period = net.instructions.size();
+
+        node_set ends { g.size() };
+        for (std::uint32_t node = 0; node < g.size(); node++) {
+          if (rng() % 4 == 0) {
+            ends.insert(node);
+          }
+        }
+        auto passes = pass_table::from_graph(g, net.instructions, ends);
+
+        // the first hits repeat within nodes passes
+        auto horizon = std::uint64_t { g.size() + 1 } * period;
+        for (std::uint32_t start = 0; start < g.size(); start++) {
+          std::optional<std::uint64_t> first_hit;
+          auto node = start;
+          for (std::uint64_t step = 0; step <= horizon; step++) {
+            if (!first_hit && ends.contains(node)) {
+              first_hit = step;
+            }
+            if (step % 37 == 0) {
+              check(passes.after_steps(g, net.instructions, start, step) ==
+                      node,
+                    "after_steps");
+            }
+            if (step % period == 0) {
+              check(passes.after_passes(start, step / period) == node,
+                    "after_passes");
+            }
+            node = g.next(node, net.instructions[step % period]);
+          }
+          check(passes.first_hit(start) == first_hit, "first_hit");
+        }
+
+        // a single instruction gets all 64 levels, nothing is out of range
+        if (passes.levels < 64) {
+          bool thrown = false;
+          try {
+            static_cast<void>(
+              passes.after_passes(0, std::uint64_t { 1 } << passes.levels));
+          } catch (std::out_of_range const&) {
+            thrown = true;
+          }
+          check(thrown, "passes beyond the levels");
+        }
+      }
+    }
+  };
+} // namespace
@@ -0,0 +1,83 @@
+#include "test.hpp"
+
+#include <aoc/day9.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  using aoc::test::check;
+
+  // p(x) = 3x^3 - 7x^2 + 2x - 11
+  constexpr auto cubic(std::int64_t x) -> std::int64_t {
+    return ((3 * x - 7) * x + 2) * x - 11;
+  }
+
+  const aoc::test::test_case polynomial_reports {
+    "day9 polynomial reports of any length", [] {
+      for (std::int64_t length : { 4, 10, 64, 65, 200 }) {
+        aoc::day9::report r;
+        for (std::int64_t x = 0; x < length; x++) {
+          r.push_back(cubic(x));
+        }
+        check(aoc::day9::interpolate(r) == cubic(length), "next value");
+        check(aoc::day9::interpolate_back(r) == cubic(-1), "previous value");
+      }
+    }
+  };
+
+  const aoc::test::test_case noisy_reports {
+    "day9 long noisy reports overflow", [] {
+      std::mt19937_64 rng { 9 };
+      aoc::day9::report r;
+      for (int i = 0; i < 200; i++) {
+        r.push_back(static_cast<std::int64_t>(rng() >> 1));
+      }
+      bool thrown = false;
+      try {
+        static_cast<void>(aoc::day9::interpolate(r));
+      } catch (std::overflow_error const&) {
+        thrown = true;
+      }
+      check(thrown, "overflow is reported");
+    }
+  };
+
+  /* constant reports extrapolate to themselves, two reports near the 64 bit
+   * limit overflow the sum of the answers while a report that pulls it back
+   * keeps it exact
+   */
+  const aoc::test::test_case report_sums {
+    "day9 sums of the reports", [] {
+      constexpr auto max = std::numeric_limits<std::int64_t>::max();
+      auto const big = std::to_string(max);
+
+      std::istringstream fits { big + " " + big + "\n-5 -5\n" };
+      auto [pt1, pt2] = aoc::day9::solution(fits);
+      check(pt1() == std::to_string(max - 5) && pt2() == pt1(),
+            "sum below the limit");
+
+      std::istringstream pulled_back { big + " " + big + "\n" + big + " " +
+                                       big + "\n-" + big + " -" + big +
+                                       "\n" };
+      auto [pt1_back, pt2_back] = aoc::day9::solution(pulled_back);
+      check(pt2_back() == big, "partial sums past the limit");
+
+      std::istringstream overflows { big + " " + big + "\n1 1\n" };
+      auto [pt1_over, pt2_over] = aoc::day9::solution(overflows);
+      for (auto const& part : { pt1_over, pt2_over }) {
+        bool thrown = false;
+        try {
+          static_cast<void>(part());
+        } catch (std::overflow_error const&) {
+          thrown = true;
+        }
+        check(thrown, "overflow is reported");
+      }
+    }
+  };
+} // namespace
@@ -0,0 +1,50 @@
+#include "test.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <print>
+#include <source_location>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace aoc::test {
+  namespace {
+    auto registry() -> std::vector<std::pair<std::string_view,
+                                             std::function<void()>>>& {
+      static std::vector<std::pair<std::string_view, std::function<void()>>>
+        tests;
+      return tests;
+    }
+
+    size_t failures = 0;
+  } // namespace
+
+  test_case::test_case(std::string_view name, std::function<void()> body) {
+    registry().emplace_back(name, std::move(body));
+  }
+
+  auto check(bool condition, std::string_view what,
+             std::source_location where) -> void {
+    if (!condition) {
+      failures++;
+      std::println("{}:{}: check failed: {}", where.file_name(), where.line(),
+                   what);
+    }
+  }
+} // namespace aoc::test
+
+auto main() -> int {
+  for (auto const& [name, body] : aoc::test::registry()) {
+    auto before = aoc::test::failures;
+    try {
+      body();
+    } catch (std::exception const& e) {
+      aoc::test::check(false, e.what());
+    }
+    std::println("[{}] {}", aoc::test::failures == before ? "ok" : "FAIL",
+                 name);
+  }
+  return aoc::test::failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <functional>
+#include <source_location>
+#include <string_view>
+
+namespace aoc::test {
+  /* registers a test case, tests are plain functions that report failures
+   * through check and are all run by the test binary
+   */
+  struct test_case {
+    test_case(std::string_view name, std::function<void()> body);
+  };
+
+  auto check(bool condition, std::string_view what,
+             std::source_location where = std::source_location::current())
+    -> void;
+} // namespace aoc::test
@@ -37,3 +37,12 @@ target("aoc_cli", function()
 	add_packages(table.unpack(aoc_cli_deps))
 	add_deps("aoc")
 end)
+
+target("test", function()
+	set_kind("binary")
+	set_default(false)
+	add_files("tests/*.cpp")
+	add_includedirs("tests")
+	add_deps("aoc")
+	add_tests("default")
+end)